@@ -0,0 +1,50 @@
+#ifndef _ACCUMULATE_H_
+#define _ACCUMULATE_H_
+
+#include <tbb/tbb.h>
+
+#include <core/Common.h>
+#include <core/Image.h>
+#include <core/Contribution.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Reduces sorted contributions into the film samples
+ *
+ * This is a tbb functor class that sums contributions that have been sorted according to sample id
+ * into the film. Each range only processes runs of equal sample ids that begin within it, so no
+ * two threads will ever write to the same sample and writes stream through the film in order.
+ */
+class Accumulate
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  Accumulate(
+    size_t _size,
+    Contribution* _data,
+    Image* _image
+    )
+   : m_size(_size)
+   , m_data(_data)
+   , m_image(_image)
+  {;}
+
+  /**
+   * @brief      Operator overloader to allow the class to act as a functor with tbb
+   *
+   * @param[in]  r           a one dimensional range over sorted contributions
+   */
+  void operator()(const tbb::blocked_range< size_t >& r) const;
+
+private:
+  size_t m_size;
+  Contribution* m_data;
+  Image* m_image;
+};
+
+MSC_NAMESPACE_END
+
+#endif
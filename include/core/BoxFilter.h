@@ -9,36 +9,26 @@ MSC_NAMESPACE_BEGIN
 /**
  * @brief      Inherits from the filter interface and represents a box filter function
  * 
- * Basic box filter to convolve samples into final image. As this operation is unlikely to be used
- * on single pixels it takes a range of data to compute the final result.
+ * Basic box filter used to splat samples into the final image.
  */
 class BoxFilter : public FilterInterface
 {
 public:
   /**
-   * @brief      Convolution function for producing final image
+   * @brief      Getter method for the filter radius
    *
-   * @param[in]  _width       width of image in pixels
-   * @param[in]  _height      height of image in pixels
-   * @param[in]  _samples     maximum samples
-   * @param[in]  _rows_begin  beginning of range to be calculated in the vertical direction
-   * @param[in]  _rows_end    end of range to be calculated in the vertical direction
-   * @param[in]  _cols_begin  beginning of range to be calculated in the horizontal direction
-   * @param[in]  _cols_end    end of range to be calculated in the horizontal direction
-   * @param      _input       input sample data
-   * @param      _output      output image
+   * @return     radius in pixels
    */
-  void convolve(
-    const size_t _width,
-    const size_t _height,
-    const size_t _samples,
-    const size_t _rows_begin,
-    const size_t _rows_end,
-    const size_t _cols_begin,
-    const size_t _cols_end,
-    Sample* _input,
-    Pixel* _output
-    ) const;
+  float radius() const;
+
+  /**
+   * @brief      One dimensional filter profile
+   *
+   * @param[in]  _distance  offset from pixel center in pixels
+   *
+   * @return     filter weight
+   */
+  float evaluate(const float _distance) const;
 };
 
 MSC_NAMESPACE_END
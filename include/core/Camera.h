@@ -2,7 +2,7 @@
 #define _CAMERA_H_
 
 #include <tbb/concurrent_queue.h>
-#include <tbb/blocked_range2d.h>
+#include <tbb/blocked_range.h>
 
 #include <core/Common.h>
 #include <core/Buffer.h>
@@ -12,6 +12,7 @@
 #include <core/CameraInterface.h>
 #include <core/SamplerInterface.h>
 #include <core/RandomGenerator.h>
+#include <core/RayUncompressed.h>
 
 MSC_NAMESPACE_BEGIN
 
@@ -20,7 +21,9 @@ MSC_NAMESPACE_BEGIN
  * 
  * This is a tbb functor class that uses the scene camera to produce primary rays and adds the
  * result into a local buffer. This is then added to the global bins that will in tern update
- * the batch queue.
+ * the batch queue. Only tiles marked as sampled for the current iteration produce rays. When an
+ * output array is given the rays of each tile are instead decompressed directly into it starting at
+ * the tile's offset, so that coherent primary rays can be traced without passing through the bins.
  */
 class Camera
 {
@@ -34,22 +37,24 @@ public:
     Image* _image,
     DirectionalBins* _bins,
     tbb::concurrent_queue< BatchItem >* _batch_queue,
-    LocalRandomGenerator* _local_thread_storage
+    RayUncompressed* _output = NULL,
+    const size_t* _offsets = NULL
     )
    : m_camera(_camera)
    , m_sampler(_sampler)
    , m_image(_image)
    , m_bins(_bins)
    , m_batch_queue(_batch_queue)
-   , m_local_thread_storage(_local_thread_storage)
+   , m_output(_output)
+   , m_offsets(_offsets)
   {;}
 
   /**
    * @brief      Operator overloader to allow the class to act as a functor with tbb
    * 
-   * @param[in]  r           a two dimentional blocked range over image resolution
+   * @param[in]  r           a one dimentional blocked range over image tiles
    */
-  void operator()(const tbb::blocked_range2d< size_t > &r) const;
+  void operator()(const tbb::blocked_range< size_t > &r) const;
 
 private:
   CameraInterface* m_camera;
@@ -57,7 +62,8 @@ private:
   Image* m_image;
   DirectionalBins* m_bins;
   tbb::concurrent_queue< BatchItem >* m_batch_queue;
-  LocalRandomGenerator* m_local_thread_storage;
+  RayUncompressed* m_output;
+  const size_t* m_offsets;
 
   mutable Buffer m_buffer;
 };
@@ -21,15 +21,22 @@ public:
    */
   virtual ~CameraInterface() {}
 
+  /**
+   * @brief      Getter method for focal length used to find the spread of primary rays
+   *
+   * @return     focal length
+   */
+  virtual float focalLength() const =0;
+
   /**
    * @brief      Creates primary rays from camera
    *
    * @param[in]  _count      sample count to process
    * @param      _positions  positions on film plane of samples
-   * @param      _random     thread local random generator to prevent mutation
+   * @param      _lens       positions on the unit square used to sample the lens
    * @param      _ouput      output of compressed rays
    */
-  virtual void sample(const int _count, float* _positions, RandomGenerator* _random, RayCompressed* _ouput) const =0;
+  virtual void sample(const int _count, float* _positions, float* _lens, RayCompressed* _ouput) const =0;
 };
 
 MSC_NAMESPACE_END
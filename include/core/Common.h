@@ -47,6 +47,12 @@ inline float misBalance(const float _first, const float _second)
   return (_first / (_first + _second));
 }
 
+inline float lobeSpread(const float _pdfw)
+{
+  // Angle subtended by the solid angle of a lobe sampled with this density
+  return fmin(M_PI, 1.f / sqrt(fmax(_pdfw, M_EPSILON)));
+}
+
 template < typename type, int size > struct BoundingBox
 {
   type min[size];
@@ -66,6 +72,44 @@ typedef Eigen::Map< msc::Colour3f > Colour3fMap;
 
 typedef Eigen::Transform< float, 3, Eigen::Affine > Affine3f;
 
+inline uint32_t octahedralEncode(const Vector3f& _normal)
+{
+  // Project onto the octahedron and fold the lower half over the upper one
+  float length = fabs(_normal.x()) + fabs(_normal.y()) + fabs(_normal.z());
+  float x = (length > 0.f) ? _normal.x() / length : 0.f;
+  float y = (length > 0.f) ? _normal.y() / length : 0.f;
+
+  if(_normal.z() < 0.f)
+  {
+    float folded_x = (1.f - fabs(y)) * ((x >= 0.f) ? 1.f : -1.f);
+    float folded_y = (1.f - fabs(x)) * ((y >= 0.f) ? 1.f : -1.f);
+    x = folded_x;
+    y = folded_y;
+  }
+
+  int16_t quantized_x = int16_t(floor(std::max(-1.f, std::min(1.f, x)) * 32767.f + 0.5f));
+  int16_t quantized_y = int16_t(floor(std::max(-1.f, std::min(1.f, y)) * 32767.f + 0.5f));
+
+  return uint32_t(uint16_t(quantized_x)) | (uint32_t(uint16_t(quantized_y)) << 16);
+}
+
+inline Vector3f octahedralDecode(const uint32_t _packed)
+{
+  float x = float(int16_t(_packed & 0xFFFF)) / 32767.f;
+  float y = float(int16_t(_packed >> 16)) / 32767.f;
+  float z = 1.f - fabs(x) - fabs(y);
+
+  if(z < 0.f)
+  {
+    float unfolded_x = (1.f - fabs(y)) * ((x >= 0.f) ? 1.f : -1.f);
+    float unfolded_y = (1.f - fabs(x)) * ((y >= 0.f) ? 1.f : -1.f);
+    x = unfolded_x;
+    y = unfolded_y;
+  }
+
+  return Vector3f(x, y, z).normalized();
+}
+
 MSC_NAMESPACE_END
 
 YAML_NAMESPACE_BEGIN
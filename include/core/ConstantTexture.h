@@ -9,9 +9,8 @@ MSC_NAMESPACE_BEGIN
 /**
  * @brief      Inherits from the shader interface and represents a constant texture
  * 
- * When initialized this will avoid creating a std::vector of data as it would be inefficient to
- * do so with non varying variables. As a result the colour method just returns the same colour
- * value without using the index.
+ * When compiled this folds into a constant operand rather than occupying a register, so blends
+ * with other constants are evaluated once at scene load.
  */
 class ConstantTexture : public TextureInterface
 {
@@ -45,23 +44,28 @@ public:
   TextureInterface* clone();
 
   /**
-   * @brief      Initialize colour values potentially as vectorized texture lookup
+   * @brief      Register texture files for conversion into tiled and mip mapped files
+   *
+   * @param      _converter  converter run at scene load
+   */
+  void preconvert(TextureConverter* _converter);
+
+  /**
+   * @brief      Resolve texture handles once at scene load to avoid looking up files by name
+   *
+   * @param[in]  _texture_system  texture system used for lookups
    */
-  void initialize(
-    const size_t _size,
-    std::vector< float >& _u,
-    std::vector< float >& _v,
-    TextureSystem _texture_system
-    );
+  void resolve(TextureSystem _texture_system);
 
   /**
-   * @brief      Gets colour value according to index
+   * @brief      Emit this node into a texture program
    *
-   * @param[in]  _index  colour index to find value for specific position
+   * @param      _program   program being compiled
+   * @param[in]  _runflags  runflags for points where this node is visible
    *
-   * @return     colour according to index
+   * @return     folded constant or register holding the result
    */
-  Colour3f colour(const size_t _index) const;
+  TextureOperand compile(TextureProgram* _program, const size_t _runflags) const;
 
 private:
   Colour3f m_constant;
@@ -0,0 +1,30 @@
+#ifndef _CONTRIBUTION_H_
+#define _CONTRIBUTION_H_
+
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <core/Common.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Radiance contribution of a path vertex towards a single film sample
+ *
+ * Rather than writing into the film directly from the integrator, contributions are collected into
+ * thread local buffers during surface shading. They are then sorted according to sample id and
+ * reduced into the film once the batch has been shaded, which avoids lost updates and false sharing
+ * on the sample array while making the order of summation independent of thread scheduling.
+ */
+struct Contribution
+{
+  unsigned int sampleID;
+  float r, g, b;
+};
+
+typedef tbb::enumerable_thread_specific< std::vector< Contribution > > LocalContributions;
+
+MSC_NAMESPACE_END
+
+#endif
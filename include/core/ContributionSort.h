@@ -0,0 +1,48 @@
+#ifndef _CONTRIBUTIONSORT_H_
+#define _CONTRIBUTIONSORT_H_
+
+#include <tbb/tbb.h>
+
+#include <core/Common.h>
+#include <core/Contribution.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Sorts contributions according to sample id using a parallel radix sort
+ *
+ * This is a least significant digit radix sort over the sample id using eight bit digits. Each pass
+ * builds histograms over fixed size blocks in parallel before scattering the blocks into a temporary
+ * array, as a result the sort is stable and the output does not depend on the number of threads.
+ * Passes where every key shares the same digit are skipped entirely.
+ */
+class ContributionSort
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  ContributionSort(
+    size_t _size,
+    Contribution* _data,
+    Contribution* _temp
+    )
+   : m_size(_size)
+   , m_data(_data)
+   , m_temp(_temp)
+  {;}
+
+  /**
+   * @brief      Operator overloader to allow the class to act as a functor with tbb
+   */
+  void operator()() const;
+
+private:
+  size_t m_size;
+  Contribution* m_data;
+  Contribution* m_temp;
+};
+
+MSC_NAMESPACE_END
+
+#endif
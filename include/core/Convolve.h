@@ -1,11 +1,12 @@
 #ifndef _CONVOLVE_H_
 #define _CONVOLVE_H_
 
-#include <tbb/blocked_range2d.h>
+#include <tbb/blocked_range.h>
 
 #include <core/Common.h>
 #include <core/Image.h>
-#include <core/FilterInterface.h>
+#include <core/FilterTable.h>
+#include <core/SamplerInterface.h>
 
 MSC_NAMESPACE_BEGIN
 
@@ -13,7 +14,13 @@ MSC_NAMESPACE_BEGIN
  * @brief      Used to filter the final image from sample data
  * 
  * This is a tbb functor class that uses the filter and image data to convolve the final image in
- * a parrallel manner. 
+ * a parrallel manner. Only tiles that were sampled during the iteration are resolved. Sample
+ * positions are regenerated from the pixel seed for the tile and its margin, each of which is then
+ * splatted into tile local accumulators for the pixels it overlaps. The separable weights are
+ * looked up for every sample of a pixel at once and the samples are held as arrays so that the
+ * inner loops vectorise. With a splat film only the filter weights are reconstructed as the colour
+ * has already been accumulated. The result is folded into the running mean of each pixel before
+ * the tile is marked dirty.
  */
 class Convolve
 {
@@ -21,23 +28,27 @@ public:
   /**
    * @brief      Initialiser list for class
    */
-  Convolve(FilterInterface* _filter, Image* _image)
+  Convolve(FilterTable* _filter, SamplerInterface* _sampler, Image* _image)
    : m_filter(_filter)
+   , m_sampler(_sampler)
    , m_image(_image)
   {;}
 
   /**
    * @brief      Operator overloader to allow the class to act as a functor with tbb
    * 
-   * @param[in]  r           a two dimentional blocked range over image resolution
+   * @param[in]  r           a one dimentional blocked range over image tiles
    */
-  void operator()(const tbb::blocked_range2d< size_t > &r) const;
+  void operator()(const tbb::blocked_range< size_t > &r) const;
 
 private:
-  FilterInterface* m_filter;
+  FilterTable* m_filter;
+  SamplerInterface* m_sampler;
   Image* m_image;
+
+  void resolve(Tile* _tile) const;
 };
 
 MSC_NAMESPACE_END
 
-#endif
\ No newline at end of file
+#endif
@@ -41,7 +41,8 @@ struct Bin
  * The DirectionalBins class combines six standard bins with one for each cardinal direction. It
  * also manages adding data from local buffers efficiently flushing this data to the batch queue
  * when required. If flushing the data is done without care to the order of which bins are cleared
- * first then performance will be dramatically reduced.
+ * first then performance will be dramatically reduced. The number of rays held in the bins or
+ * waiting on the queue is tracked so that ray generation can be throttled against it.
  */
 class DirectionalBins
 {
@@ -75,9 +76,24 @@ public:
    */
   void flush(tbb::concurrent_queue< BatchItem >* _batch_queue);
 
+  /**
+   * @brief      Release rays of a batch taken from the queue for processing
+   *
+   * @param[in]  _size  number of rays in the batch
+   */
+  inline void release(const size_t _size) {m_pending -= _size;}
+
+  /**
+   * @brief      Get number of rays held in the bins or waiting on the queue
+   *
+   * @return     pending ray count
+   */
+  inline size_t pending() const {return m_pending;}
+
 private:
   size_t m_exponent;
   Bin m_bin[6];
+  boost::atomic< size_t > m_pending;
 };
 
 MSC_NAMESPACE_END
@@ -2,15 +2,15 @@
 #define _FILTERINTERFACE_H_
 
 #include <core/Common.h>
-#include <core/Image.h>
 
 MSC_NAMESPACE_BEGIN
 
 /**
  * @brief      Abstract interface class for image filtering
  * 
- * This is a simple interface for using a filter in a polymophic sense. As this operation is
- * unlikely to be used on single pixels it takes a range of data to compute the final result.
+ * This is a simple interface for using a filter in a polymophic sense. Every filter is assumed to
+ * be separable so only a one dimensional profile is required, this is evaluated once into a weight
+ * table at scene construction rather than being called for every sample and pixel pair.
  */
 class FilterInterface
 {
@@ -21,29 +21,20 @@ public:
   virtual ~FilterInterface() {}
 
   /**
-   * @brief      Convolution function for producing final image
+   * @brief      Getter method for the filter radius
    *
-   * @param[in]  _width       width of image in pixels
-   * @param[in]  _height      height of image in pixels
-   * @param[in]  _samples     maximum samples
-   * @param[in]  _rows_begin  begining of range to be calcualted in the vertical direction
-   * @param[in]  _rows_end    end of range to be calcualted in the vertical direction
-   * @param[in]  _cols_begin  begining of range to be calcualted in the horizontal direction
-   * @param[in]  _cols_end    end of range to be calcualted in the horizontal direction
-   * @param      _input       input sample data
-   * @param      _output      output image
+   * @return     radius in pixels
    */
-  virtual void convolve(
-    const size_t _width,
-    const size_t _height,
-    const size_t _samples,
-    const size_t _rows_begin,
-    const size_t _rows_end,
-    const size_t _cols_begin,
-    const size_t _cols_end,
-    Sample* _input,
-    Pixel* _output
-    ) const =0;
+  virtual float radius() const =0;
+
+  /**
+   * @brief      One dimensional filter profile
+   *
+   * @param[in]  _distance  offset from pixel center in pixels
+   *
+   * @return     filter weight
+   */
+  virtual float evaluate(const float _distance) const =0;
 };
 
 MSC_NAMESPACE_END
@@ -0,0 +1,76 @@
+#ifndef _FILTERTABLE_H_
+#define _FILTERTABLE_H_
+
+#include <vector>
+
+#include <core/Common.h>
+#include <core/FilterInterface.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Precomputed weight table for a separable filter
+ * 
+ * The filter profile is tabulated over its radius so that reconstruction only requires a table
+ * lookup per axis. Weights are evaluated for arrays of offsets at a time so that the loops can be
+ * vectorised by the compiler, the two dimensional weight is then the product of both axes.
+ */
+class FilterTable
+{
+public:
+  /**
+   * @brief      This constructor will tabulate the filter profile
+   *
+   * @param[in]  _filter      filter to tabulate
+   * @param[in]  _resolution  number of table entries across the radius
+   */
+  FilterTable(const FilterInterface* _filter, const size_t _resolution = 1024);
+
+  /**
+   * @brief      Getter method for the filter radius
+   *
+   * @return     radius in pixels
+   */
+  inline float radius() const {return m_radius;}
+
+  /**
+   * @brief      Number of neighbouring pixels a sample within a pixel can contribute toward
+   *
+   * @return     margin in pixels
+   */
+  inline int margin() const {return m_margin;}
+
+  /**
+   * @brief      Look up the weight of a single offset
+   *
+   * @param[in]  _distance  offset from pixel center in pixels
+   *
+   * @return     filter weight
+   */
+  inline float evaluate(const float _distance) const
+  {
+    float distance = fminf(fabsf(_distance) * m_scale, float(m_resolution + 1));
+    return m_table[static_cast< size_t >(distance)];
+  }
+
+  /**
+   * @brief      Look up the weights of an array of sample positions against a pixel center
+   *
+   * @param[in]  _count     number of positions
+   * @param[in]  _center    pixel center
+   * @param[in]  _position  sample positions
+   * @param      _output    output weights
+   */
+  void evaluate(const size_t _count, const float _center, const float* _position, float* _output) const;
+
+private:
+  float m_radius;
+  int m_margin;
+  float m_scale;
+  size_t m_resolution;
+  std::vector< float > m_table;
+};
+
+MSC_NAMESPACE_END
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef _GAUSSIANFILTER_H_
+#define _GAUSSIANFILTER_H_
+
+#include <core/Common.h>
+#include <core/FilterInterface.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Inherits from the filter interface and represents a gaussian filter function
+ * 
+ * Gaussian filter that is offset so that it falls to zero at the radius. This gives a smoother
+ * result than the tent filter at the cost of some sharpness.
+ */
+class GaussianFilter : public FilterInterface
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  GaussianFilter()
+    : m_radius(1.5f)
+    , m_alpha(2.f)
+  {;}
+
+  /**
+   * @brief      Getter method for the filter radius
+   *
+   * @return     radius in pixels
+   */
+  float radius() const;
+
+  /**
+   * @brief      Getter method for falloff
+   *
+   * @return     falloff
+   */
+  inline float alpha() const {return m_alpha;}
+
+  /**
+   * @brief      Setter method for the filter radius
+   *
+   * @param[in]  _radius  radius in pixels
+   */
+  void radius(const float _radius){m_radius = _radius;}
+
+  /**
+   * @brief      Setter method for falloff
+   *
+   * @param[in]  _alpha  falloff
+   */
+  void alpha(const float _alpha){m_alpha = _alpha;}
+
+  /**
+   * @brief      One dimensional filter profile
+   *
+   * @param[in]  _distance  offset from pixel center in pixels
+   *
+   * @return     filter weight
+   */
+  float evaluate(const float _distance) const;
+
+private:
+  float m_radius;
+  float m_alpha;
+};
+
+MSC_NAMESPACE_END
+
+YAML_NAMESPACE_BEGIN
+
+template<> struct convert<msc::GaussianFilter>
+{
+  static bool decode(const Node& node, msc::GaussianFilter& rhs)
+  {
+    if(!node.IsMap() || node.size() != 3)
+      return false;
+
+    rhs.radius(node["radius"].as<float>());
+    rhs.alpha(node["alpha"].as<float>());
+    
+    return true;
+  }
+};
+
+YAML_NAMESPACE_END
+
+#endif
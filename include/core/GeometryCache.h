@@ -0,0 +1,166 @@
+#ifndef _GEOMETRYCACHE_H_
+#define _GEOMETRYCACHE_H_
+
+#include <vector>
+
+#include <tbb/tbb.h>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <core/Common.h>
+#include <core/EmbreeWrapper.h>
+#include <core/PolygonObject.h>
+#include <core/SceneBundle.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Pages polygon geometry of a scene bundle in and out of memory
+ *
+ * When geometry is paged the main scene only holds a bounding box proxy for every object along
+ * with the lights, so it stays small however large the meshes are. Rays are first traversed across
+ * the proxies to find the objects they may hit, and those are then intersected with their own
+ * acceleration structures, which are built from the mapped bundle when first needed. Each sorted
+ * batch requests its meshes before it is traced so they can be built together, and meshes that
+ * have not been used for the longest are released between batches once the budget is exceeded.
+ * The budget counts the arrays of resident meshes, whose acceleration structures are released with
+ * them. A batch always gets all the geometry it requests, so the budget may be exceeded while it is
+ * traced. Shadow rays cast during shading build any mesh they are missing on demand. These count
+ * towards the resident total like any other and are released at the next update once the budget is
+ * exceeded, and the highest total ever reached is kept as the peak. Intersection and occlusion
+ * queries may run concurrently from any number of threads but never alongside update, which
+ * advances the usage stamp they read without synchronisation.
+ */
+class GeometryCache
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   *
+   * @param[in]  _bundle       scene bundle that geometry is mapped from
+   * @param[in]  _budget       memory budget in megabytes
+   * @param[in]  _scene_flags  embree flags used to build each mesh
+   */
+  GeometryCache(const boost::shared_ptr< SceneBundle >& _bundle, const float _budget, const int _scene_flags);
+
+  /**
+   * @brief      Releases acceleration structures of resident meshes
+   */
+  ~GeometryCache();
+
+  /**
+   * @brief      Registers mapped geometry that can be paged
+   *
+   * @param[in]  _mesh         polygon object mapped from the bundle
+   * @param[in]  _bundle_mesh  index of the mesh within the bundle
+   *
+   * @return     page index
+   */
+  size_t page(const boost::shared_ptr< PolygonObject >& _mesh, const size_t _bundle_mesh);
+
+  /**
+   * @brief      Adds bounding box proxy of a placed page to a scene
+   *
+   * @param[in]  _scene      embree scene holding the proxies
+   * @param[in]  _page       page index
+   * @param[in]  _transform  placement of the page in world space
+   *
+   * @return     geometry id of the proxy
+   */
+  unsigned int proxy(RTCScene _scene, const size_t _page, const Affine3f& _transform);
+
+  /**
+   * @brief      Marks pages that a ray may reach so they are built before tracing
+   *
+   * @param[in]  _scene  embree scene holding the proxies
+   * @param[in]  _ray    ray to be traced
+   */
+  void request(RTCScene _scene, const RTCRay& _ray);
+
+  /**
+   * @brief      Releases cold pages to fit the budget and builds requested pages, must not be called
+   *             while rays are being traced
+   */
+  void update();
+
+  /**
+   * @brief      Finds closest hit of a ray across lights and paged geometry
+   *
+   * @param[in]  _scene  embree scene holding the proxies
+   * @param      _ray    ray that receives the hit, instances resolve to their object
+   */
+  void intersect(RTCScene _scene, RTCRay& _ray);
+
+  /**
+   * @brief      Tests whether a ray is blocked by paged geometry
+   *
+   * @param[in]  _scene  embree scene holding the proxies
+   * @param      _ray    ray whose geometry id is set to zero when occluded
+   */
+  void occluded(RTCScene _scene, RTCRay& _ray);
+
+  /**
+   * @brief      Getter method for memory held by resident pages
+   *
+   * @return     bytes
+   */
+  inline size_t resident() const {return m_resident.load();}
+
+  /**
+   * @brief      Getter method for highest memory held by resident pages, including pages built on
+   *             demand while tracing
+   *
+   * @return     bytes
+   */
+  inline size_t peak() const {return m_peak.load();}
+
+  /**
+   * @brief      Getter method for number of pages built
+   *
+   * @return     build count
+   */
+  inline size_t builds() const {return m_builds.load();}
+
+  /**
+   * @brief      Getter method for number of pages released
+   *
+   * @return     eviction count
+   */
+  inline size_t evictions() const {return m_evictions;}
+
+private:
+  struct CachePage;
+  struct CacheBuild;
+  struct CacheLoading;
+
+  struct CacheProxy
+  {
+    size_t page;
+    Eigen::Matrix3f linear;
+    Vector3f translation;
+  };
+
+  typedef std::vector< std::pair< float, unsigned int > > Candidates;
+
+  void gather(RTCScene _scene, RTCRay& _ray, Candidates* _candidates) const;
+  RTCScene fetch(const size_t _page);
+  void evict(const size_t _page);
+
+  boost::shared_ptr< SceneBundle > m_bundle;
+  size_t m_budget;
+  int m_scene_flags;
+
+  std::vector< boost::shared_ptr< CachePage > > m_pages;
+  std::vector< CacheProxy > m_proxies;
+  tbb::enumerable_thread_specific< Candidates > m_candidates;
+
+  size_t m_stamp;
+  size_t m_evictions;
+  boost::atomic< size_t > m_resident;
+  boost::atomic< size_t > m_peak;
+  boost::atomic< size_t > m_builds;
+};
+
+MSC_NAMESPACE_END
+
+#endif
@@ -3,18 +3,20 @@
 
 #include <vector>
 
+#include <tbb/cache_aligned_allocator.h>
+
 #include <core/Common.h>
 
 MSC_NAMESPACE_BEGIN
 
 /**
- * @brief      Sample structure representing colour and position on image
+ * @brief      Sample structure representing colour on image
  * 
  * A single sample with minimum data as to conserve system memory when using large sample counts.
+ * The position of the sample is not stored as it can be regenerated from the pixel seed.
  */
 struct Sample
 {
-  float x, y;
   float r, g, b;
 };
 
@@ -30,13 +32,47 @@ union Pixel
   float v[3];
 };
 
+/**
+ * @brief      Storage mode of the film
+ * 
+ * The sample film stores the colour of every sample and filters them once the iteration is complete.
+ * The splat film instead splats contributions into filter weighted pixel accumulators as they are
+ * shaded, so memory usage is proportional to the pixel count rather than the sample count.
+ */
+enum FilmMode
+{
+  FILM_SAMPLE,
+  FILM_SPLAT
+};
+
+/**
+ * @brief      Rectangular region of the image that is sampled and resolved as a unit
+ * 
+ * The image is divided into tiles matching the bucket size. Each tile tracks how many iterations
+ * it has resolved along with whether it was sampled during the current iteration and whether it has
+ * changed since it was last previewed, so that only the tiles that change are filtered and uploaded.
+ * The error is the average relative standard error of its pixels and is used for adaptive sampling.
+ */
+struct Tile
+{
+  size_t x, y;
+  size_t width, height;
+  size_t iteration;
+  float error;
+  bool sampled;
+  bool dirty;
+};
+
 /**
  * @brief      Image structure that contains sample and pixel data
  * 
  * Basic image structure that contains width and height information as well as the base value for
  * the sample count. The iteration count represents how many times each pixel has received an
  * approximation of the lighting integral. The data itself is stored in std::vectors to allow
- * for automatic clean up.
+ * for automatic clean up, these are cache aligned so that sorted accumulation into the samples
+ * streams through whole cache lines. Depending on the film mode either the samples or the splat
+ * accumulators are allocated. The pixels hold the running mean of each resolved iteration while
+ * the variance holds the running sum of squared luminance deviations from that mean.
  */
 struct Image
 {
@@ -44,11 +80,52 @@ struct Image
   size_t height;
   size_t base;
   size_t iteration;
+  FilmMode film;
+
+  size_t tile_size;
+  size_t tile_columns;
+  std::vector< Tile > tiles;
 
-  std::vector< Sample > samples;
-  std::vector< Pixel > pixels;
+  std::vector< Sample, tbb::cache_aligned_allocator< Sample > > samples;
+  std::vector< Pixel, tbb::cache_aligned_allocator< Pixel > > splats;
+  std::vector< Pixel, tbb::cache_aligned_allocator< Pixel > > pixels;
+  std::vector< float, tbb::cache_aligned_allocator< float > > variance;
 };
 
+/**
+ * @brief      Luminance of a pixel used for variance estimation
+ *
+ * @param[in]  _pixel  pixel
+ *
+ * @return     luminance
+ */
+inline float luminance(const Pixel& _pixel)
+{
+  return 0.2126f * _pixel.r + 0.7152f * _pixel.g + 0.0722f * _pixel.b;
+}
+
+/**
+ * @brief      Seed used to generate the sample positions of a pixel
+ * 
+ * Sample positions are never stored, instead the sampler is seeded per pixel and iteration so
+ * that positions can be regenerated exactly when reconstructing the image.
+ *
+ * @param[in]  _pixel      pixel index
+ * @param[in]  _iteration  current iteration
+ *
+ * @return     seed value
+ */
+inline unsigned int pixelSeed(const size_t _pixel, const size_t _iteration)
+{
+  unsigned int seed = static_cast< unsigned int >(_pixel) ^ (static_cast< unsigned int >(_iteration) * 0x9E3779B9u);
+  seed = (seed ^ 61u) ^ (seed >> 16);
+  seed = seed + (seed << 3);
+  seed = seed ^ (seed >> 4);
+  seed = seed * 0x27D4EB2Du;
+  seed = seed ^ (seed >> 15);
+  return seed;
+}
+
 MSC_NAMESPACE_END
 
 YAML_NAMESPACE_BEGIN
@@ -57,13 +134,18 @@ template<> struct convert<msc::Image>
 {
   static bool decode(const Node& node, msc::Image& rhs)
   {
-    if(!node.IsMap() || node.size() != 3)
+    if(!node.IsMap() || node.size() < 3)
       return false;
 
     rhs.width = node["width"].as<int>();
     rhs.height = node["height"].as<int>();
     rhs.base = node["sample base"].as<int>();
     rhs.iteration = 0;
+
+    rhs.film = msc::FILM_SAMPLE;
+    if(node["film"] && node["film"].as< std::string >() == "Splat")
+      rhs.film = msc::FILM_SPLAT;
+
     return true;
   }
 };
@@ -0,0 +1,224 @@
+#ifndef _INSTANCEOBJECT_H_
+#define _INSTANCEOBJECT_H_
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <core/Common.h>
+#include <core/ObjectInterface.h>
+#include <core/PolygonObject.h>
+#include <core/Singleton.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Inherits from the object interface and places shared polygon geometry with a transform
+ *
+ * Instances reference a polygon object that was read once in its local space and is shared between
+ * every instance of the same file. Embree traverses the shared geometry through a per instance
+ * transform, so hits arrive in local space where texture coordinates can be looked up directly,
+ * while geometric normals and texture densities are brought into world space by the instance.
+ */
+class InstanceObject : public ObjectInterface
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  InstanceObject()
+    : m_translation(Vector3f(0.f, 0.f, 0.f))
+    , m_rotation(Vector3f(0.f, 0.f, 0.f))
+    , m_scale(Vector3f(1.f, 1.f, 1.f))
+  {;}
+
+  /**
+   * @brief      Getter method for filename
+   *
+   * @return     filename string
+   */
+  inline std::string filename() const {return m_filename;}
+
+  /**
+   * @brief      Getter method for shader id
+   *
+   * @return     shader id
+   */
+  inline int shader() const {return m_shader;}
+
+  /**
+   * @brief      Getter method for shared geometry
+   *
+   * @return     polygon object in local space
+   */
+  inline PolygonObject* mesh() const {return m_mesh.get();}
+
+  /**
+   * @brief      Get column major three by four transform as expected by embree
+   *
+   * @return     transform pointer
+   */
+  inline const float* transform() const {return m_transform;}
+
+  /**
+   * @brief      Setter method for filename
+   *
+   * @param[in]  _filename  filename string
+   */
+  void filename(const std::string &_filename){m_filename = _filename;}
+
+  /**
+   * @brief      Setter method for translation
+   *
+   * @param[in]  _translation  translation vector
+   */
+  void translation(const Vector3f &_translation){m_translation = _translation;}
+
+  /**
+   * @brief      Setter method for rotation
+   *
+   * @param[in]  _rotation  euler angle vector
+   */
+  void rotation(const Vector3f &_rotation){m_rotation = _rotation;}
+
+  /**
+   * @brief      Setter method for scale
+   *
+   * @param[in]  _scale  scale vector
+   */
+  void scale(const Vector3f &_scale){m_scale = _scale;}
+
+  /**
+   * @brief      Setter method for shader id
+   *
+   * @param[in]  _shader  shader id
+   */
+  void shader(const int &_shader){m_shader = _shader;}
+
+  /**
+   * @brief      Setter method for shared geometry
+   *
+   * @param[in]  _mesh  polygon object in local space
+   */
+  void mesh(const boost::shared_ptr< PolygonObject >& _mesh){m_mesh = _mesh;}
+
+  /**
+   * @brief      Precomputes instance transforms
+   */
+  void construct();
+
+  /**
+   * @brief      Gets u and v texture coordinates
+   *
+   * @param[in]  _primitive  primitive index value
+   * @param[in]  _s          s coordinate
+   * @param[in]  _t          t coordinate
+   * @param      _output     output uv coordinates
+   */
+  void texture(
+    const size_t _primitive,
+    const float _s,
+    const float _t,
+    Vector2f* _output
+    ) const;
+
+  /**
+   * @brief      Gets texture density used to convert a world footprint into texture space
+   *
+   * @param[in]  _primitive  primitive index value
+   *
+   * @return     texture space length per unit of world space length
+   */
+  float density(const size_t _primitive) const;
+
+  /**
+   * @brief      Interpolates texture coordinates and world space densities for a range of hits
+   *
+   * @param[in]  _size        number of hits
+   * @param[in]  _primitives  primitive index values
+   * @param[in]  _s           s coordinates
+   * @param[in]  _t           t coordinates
+   * @param      _u           output u texture coordinates
+   * @param      _v           output v texture coordinates
+   * @param      _density     output texture densities, skipped when null
+   */
+  void interpolateTexcoords(
+    const size_t _size,
+    const int* _primitives,
+    const float* _s,
+    const float* _t,
+    float* _u,
+    float* _v,
+    float* _density
+    ) const;
+
+  /**
+   * @brief      Interpolates normals of shared geometry and brings them into world space
+   *
+   * @param[in]  _size        number of hits
+   * @param[in]  _primitives  primitive index values
+   * @param[in]  _s           s coordinates
+   * @param[in]  _t           t coordinates
+   * @param      _x           output unnormalised x components
+   * @param      _y           output unnormalised y components
+   * @param      _z           output unnormalised z components
+   */
+  void interpolateNormals(
+    const size_t _size,
+    const int* _primitives,
+    const float* _s,
+    const float* _t,
+    float* _x,
+    float* _y,
+    float* _z
+    ) const;
+
+  /**
+   * @brief      Transforms geometric normal from local into world space
+   *
+   * @param[in]  _normal  geometric normal in local space
+   *
+   * @return     unnormalised normal in world space
+   */
+  Vector3f worldNormal(const Vector3f& _normal) const;
+
+private:
+  std::string m_filename;
+  Vector3f m_translation;
+  Vector3f m_rotation;
+  Vector3f m_scale;
+  int m_shader;
+
+  boost::shared_ptr< PolygonObject > m_mesh;
+  float m_transform[12];
+  Eigen::Matrix3f m_linear;
+  Eigen::Matrix3f m_normal_transform;
+};
+
+MSC_NAMESPACE_END
+
+YAML_NAMESPACE_BEGIN
+
+template<> struct convert<msc::InstanceObject>
+{
+  static bool decode(const Node& node, msc::InstanceObject& rhs)
+  {
+    if(!node.IsMap() || node.size() != 6)
+      return false;
+
+    msc::SingletonString& scene_root = msc::SingletonString::instance();
+    rhs.filename(scene_root.getData().append("/").append(node["filename"].as<std::string>()));
+    rhs.translation(node["translation"].as<msc::Vector3f>());
+    rhs.rotation(node["rotation"].as<msc::Vector3f>());
+    rhs.scale(node["scale"].as<msc::Vector3f>());
+    rhs.shader(node["shader"].as<int>());
+
+    rhs.construct();
+
+    return true;
+  }
+};
+
+YAML_NAMESPACE_END
+
+#endif
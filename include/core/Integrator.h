@@ -8,8 +8,8 @@
 #include <core/Buffer.h>
 #include <core/DirectionalBins.h>
 #include <core/Scene.h>
-#include <core/Image.h>
 #include <core/Settings.h>
+#include <core/Contribution.h>
 #include <core/BatchItem.h>
 #include <core/RayUncompressed.h>
 #include <core/RayCompressed.h>
@@ -17,6 +17,10 @@
 
 MSC_NAMESPACE_BEGIN
 
+class Prefetch;
+
+typedef tbb::enumerable_thread_specific< std::vector< size_t > > LocalDepthHistogram;
+
 /**
  * @brief      A range template that describes a one dimensional range containing an equal comparison
  *
@@ -116,10 +120,16 @@ public:
  * This class is a tbb functor that will integrate the rendering equation using a uni-directional
  * path tracing algorithm. It will optimise the process by using next event estimation as well as
  * multiple importance sampling of both the light and brdf strategies. Russian roulette is also used
- * for path termination within a defined range using a threshold. It is divided into five main
- * section that are: no intersection found, intersected light, texture caching/initialization,
- * next event estimation and continuation of random walk. This order of operation is influenced by
- * the design of the SmallVCM renderer.
+ * for path termination, with a probability driven by the throughput the path would carry past the
+ * vertex relative to a threshold, and the depth of every terminated path is counted. It is divided
+ * into five main section that are: no intersection found, intersected light, texture
+ * caching/initialization, next event estimation and continuation of random walk. This order of
+ * operation is influenced by the design of the SmallVCM renderer. Radiance is not written into the
+ * film directly, instead contributions are appended to thread local buffers that are reduced once
+ * the batch is shaded. Random numbers are drawn from scrambled Sobol sequences keyed on the pixel
+ * and depth of each path vertex and indexed by sample and iteration, with fixed dimensions
+ * allocated to each use. The result therefore does not depend on how ranges are scheduled across
+ * threads.
  */
 class Integrator
 {
@@ -129,22 +139,30 @@ public:
    */
   Integrator(
     Scene* _scene,
-    Image* _image,
     Settings* _settings,
     DirectionalBins* _bins,
     tbb::concurrent_queue< BatchItem >* _batch_queue,
-    LocalTextureSystem* _local_thread_storage_texture,
-    LocalRandomGenerator* _local_thread_storage_random,
-    RayUncompressed* _batch
+    TextureSystem _texture_system,
+    LocalTexturePerthread* _local_thread_storage_texture,
+    LocalContributions* _local_thread_storage_contributions,
+    LocalDepthHistogram* _local_thread_storage_histogram,
+    RayUncompressed* _batch,
+    size_t _samples,
+    size_t _iteration,
+    Prefetch* _prefetch
     )
    : m_scene(_scene)
-   , m_image(_image)
    , m_settings(_settings)
    , m_bins(_bins)
    , m_batch_queue(_batch_queue)
+   , m_texture_system(_texture_system)
    , m_local_thread_storage_texture(_local_thread_storage_texture)
-   , m_local_thread_storage_random(_local_thread_storage_random)
+   , m_local_thread_storage_contributions(_local_thread_storage_contributions)
+   , m_local_thread_storage_histogram(_local_thread_storage_histogram)
    , m_batch(_batch)
+   , m_samples(_samples)
+   , m_iteration(_iteration)
+   , m_prefetch(_prefetch)
   {;}
 
   /**
@@ -154,17 +172,42 @@ public:
    */
   void operator()(const RangeGeom< RayUncompressed* > &r) const;
 
+  /**
+   * @brief      Compute texture coordinates and filter widths for a range of hit points
+   *
+   * @param[in]  _object     object that was hit
+   * @param[in]  _hits       first hit point of range
+   * @param[in]  _size       number of hit points
+   * @param[in]  _stride     step between hit points that are used
+   * @param      _u          u texture coordinates
+   * @param      _v          v texture coordinates
+   * @param      _footprint  filter width in texture space from the ray cone
+   */
+  static void coordinates(
+    const ObjectInterface* _object,
+    const RayUncompressed* _hits,
+    const size_t _size,
+    const size_t _stride,
+    std::vector< float >* _u,
+    std::vector< float >* _v,
+    std::vector< float >* _footprint
+    );
+
 private:
   Scene* m_scene;
-  Image* m_image;
   Settings* m_settings;
 
   DirectionalBins* m_bins;
   tbb::concurrent_queue< BatchItem >* m_batch_queue;
-  LocalTextureSystem* m_local_thread_storage_texture;
-  LocalRandomGenerator* m_local_thread_storage_random;
+  TextureSystem m_texture_system;
+  LocalTexturePerthread* m_local_thread_storage_texture;
+  LocalContributions* m_local_thread_storage_contributions;
+  LocalDepthHistogram* m_local_thread_storage_histogram;
   
   RayUncompressed* m_batch;
+  size_t m_samples;
+  size_t m_iteration;
+  Prefetch* m_prefetch;
 
   mutable Buffer m_buffer;
 };
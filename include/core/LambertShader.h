@@ -8,6 +8,7 @@
 #include <core/Common.h>
 #include <core/ShaderInterface.h>
 #include <core/TextureInterface.h>
+#include <core/TextureProgram.h>
 #include <core/StandardTexture.h>
 #include <core/ConstantTexture.h>
 #include <core/LayeredTexture.h>
@@ -20,7 +21,8 @@ MSC_NAMESPACE_BEGIN
  * This shader will evaluate a perfectly diffuse surface and importance sample the hemisphere
  * according to the cosine term in the rendering equation. This is required for multiple importance
  * sampling within the integrator. It also implements the clone and initialize methods so that
- * texture information can be cached with multiple shading points simultaneously.
+ * texture information can be cached with multiple shading points simultaneously. The texture tree
+ * is compiled into a texture program when resolved, which is shared between clones.
  */
 class LambertShader : public ShaderInterface
 {
@@ -30,6 +32,7 @@ public:
    */
   LambertShader()
     : m_reflectance(1.f)
+    , m_size(0)
   {;}
 
   /**
@@ -74,9 +77,44 @@ public:
     const size_t _size,
     std::vector< float >& _u,
     std::vector< float >& _v,
-    TextureSystem _texture_system
+    std::vector< float >& _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info
     );
 
+  /**
+   * @brief      Fault the texture tiles under a set of points into the cache without filtering
+   *
+   * @param[in]  _size            number of points
+   * @param[in]  _u               u texture coordinates
+   * @param[in]  _v               v texture coordinates
+   * @param[in]  _footprint       filter width in texture space
+   * @param[in]  _texture_system  texture system used for lookups
+   * @param[in]  _thread_info     per thread texture system information
+   */
+  void prefetch(
+    const size_t _size,
+    const float* _u,
+    const float* _v,
+    const float* _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info
+    ) const;
+
+  /**
+   * @brief      Register texture files for conversion into tiled and mip mapped files
+   *
+   * @param      _converter  converter run at scene load
+   */
+  void preconvert(TextureConverter* _converter);
+
+  /**
+   * @brief      Resolve texture handles once at scene load to avoid looking up files by name
+   *
+   * @param[in]  _texture_system  texture system used for lookups
+   */
+  void resolve(TextureSystem _texture_system);
+
   /**
    * @brief      Get probabilty of bsdf reflectance for russian roulette
    *
@@ -130,7 +168,13 @@ public:
 
 private:
   boost::shared_ptr< TextureInterface > m_texture;
+  boost::shared_ptr< TextureProgram > m_program;
   float m_reflectance;
+
+  std::vector< float > m_colour;
+  size_t m_size;
+
+  Colour3f colour(const size_t _index) const;
 };
 
 MSC_NAMESPACE_END
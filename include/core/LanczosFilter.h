@@ -0,0 +1,90 @@
+#ifndef _LANCZOSFILTER_H_
+#define _LANCZOSFILTER_H_
+
+#include <core/Common.h>
+#include <core/FilterInterface.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Inherits from the filter interface and represents a windowed sinc filter
+ * 
+ * Sinc filter windowed by a lanczos function where tau sets the number of lobes within the radius.
+ * This is the sharpest of the filters although the negative lobes may produce ringing.
+ */
+class LanczosFilter : public FilterInterface
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  LanczosFilter()
+    : m_radius(3.f)
+    , m_tau(3.f)
+  {;}
+
+  /**
+   * @brief      Getter method for the filter radius
+   *
+   * @return     radius in pixels
+   */
+  float radius() const;
+
+  /**
+   * @brief      Getter method for window size
+   *
+   * @return     tau
+   */
+  inline float tau() const {return m_tau;}
+
+  /**
+   * @brief      Setter method for the filter radius
+   *
+   * @param[in]  _radius  radius in pixels
+   */
+  void radius(const float _radius){m_radius = _radius;}
+
+  /**
+   * @brief      Setter method for window size
+   *
+   * @param[in]  _tau  tau
+   */
+  void tau(const float _tau){m_tau = _tau;}
+
+  /**
+   * @brief      One dimensional filter profile
+   *
+   * @param[in]  _distance  offset from pixel center in pixels
+   *
+   * @return     filter weight
+   */
+  float evaluate(const float _distance) const;
+
+private:
+  float m_radius;
+  float m_tau;
+
+  float sinc(const float _x) const;
+};
+
+MSC_NAMESPACE_END
+
+YAML_NAMESPACE_BEGIN
+
+template<> struct convert<msc::LanczosFilter>
+{
+  static bool decode(const Node& node, msc::LanczosFilter& rhs)
+  {
+    if(!node.IsMap() || node.size() != 3)
+      return false;
+
+    rhs.radius(node["radius"].as<float>());
+    rhs.tau(node["tau"].as<float>());
+    
+    return true;
+  }
+};
+
+YAML_NAMESPACE_END
+
+#endif
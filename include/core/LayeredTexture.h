@@ -14,7 +14,9 @@ MSC_NAMESPACE_BEGIN
  * This texture takes two base textures and combines them using a mask texture. Each texture and
  * the mask can be of any other texture type, that currently being a constant, standard texture or
  * possibly another texture. As there is no integral to be sampled, russian roulette is not used
- * as this would introduce variance with minimal performance increase.
+ * as this would introduce variance with minimal performance increase. When compiled, constant masks
+ * prune the hidden layer entirely and varying masks restrict the lookups of each layer to the
+ * points where it is visible.
  */
 class LayeredTexture : public TextureInterface
 {
@@ -69,29 +71,33 @@ public:
   TextureInterface* clone();
 
   /**
-   * @brief      Initialize colour values potentially as vectorized texture lookup
+   * @brief      Register texture files for conversion into tiled and mip mapped files
+   *
+   * @param      _converter  converter run at scene load
+   */
+  void preconvert(TextureConverter* _converter);
+
+  /**
+   * @brief      Resolve texture handles once at scene load to avoid looking up files by name
+   *
+   * @param[in]  _texture_system  texture system used for lookups
    */
-  void initialize(
-    const size_t _size,
-    std::vector< float >& _u,
-    std::vector< float >& _v,
-    TextureSystem _texture_system
-    );
+  void resolve(TextureSystem _texture_system);
 
   /**
-   * @brief      Gets colour value according to index
+   * @brief      Emit this node into a texture program
    *
-   * @param[in]  _index  colour index to find value for specific position
+   * @param      _program   program being compiled
+   * @param[in]  _runflags  runflags for points where this node is visible
    *
-   * @return     colour according to index
+   * @return     folded constant or register holding the result
    */
-  Colour3f colour(const size_t _index) const;
+  TextureOperand compile(TextureProgram* _program, const size_t _runflags) const;
 
 private:
   boost::shared_ptr< TextureInterface > m_upper;
   boost::shared_ptr< TextureInterface > m_lower;
   boost::shared_ptr< TextureInterface > m_mask;
-  std::vector< Colour3f > m_colour;
 };
 
 MSC_NAMESPACE_END
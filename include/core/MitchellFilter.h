@@ -0,0 +1,105 @@
+#ifndef _MITCHELLFILTER_H_
+#define _MITCHELLFILTER_H_
+
+#include <core/Common.h>
+#include <core/FilterInterface.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Inherits from the filter interface and represents a mitchell netravali filter
+ * 
+ * Cubic filter parameterised by b and c which trades blurring against ringing, the default values
+ * are those recommended by Mitchell and Netravali. The negative lobes may produce slight ringing.
+ */
+class MitchellFilter : public FilterInterface
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  MitchellFilter()
+    : m_radius(2.f)
+    , m_b(1.f / 3.f)
+    , m_c(1.f / 3.f)
+  {;}
+
+  /**
+   * @brief      Getter method for the filter radius
+   *
+   * @return     radius in pixels
+   */
+  float radius() const;
+
+  /**
+   * @brief      Getter method for b
+   *
+   * @return     b
+   */
+  inline float b() const {return m_b;}
+
+  /**
+   * @brief      Getter method for c
+   *
+   * @return     c
+   */
+  inline float c() const {return m_c;}
+
+  /**
+   * @brief      Setter method for the filter radius
+   *
+   * @param[in]  _radius  radius in pixels
+   */
+  void radius(const float _radius){m_radius = _radius;}
+
+  /**
+   * @brief      Setter method for b
+   *
+   * @param[in]  _b    b
+   */
+  void b(const float _b){m_b = _b;}
+
+  /**
+   * @brief      Setter method for c
+   *
+   * @param[in]  _c    c
+   */
+  void c(const float _c){m_c = _c;}
+
+  /**
+   * @brief      One dimensional filter profile
+   *
+   * @param[in]  _distance  offset from pixel center in pixels
+   *
+   * @return     filter weight
+   */
+  float evaluate(const float _distance) const;
+
+private:
+  float m_radius;
+  float m_b;
+  float m_c;
+};
+
+MSC_NAMESPACE_END
+
+YAML_NAMESPACE_BEGIN
+
+template<> struct convert<msc::MitchellFilter>
+{
+  static bool decode(const Node& node, msc::MitchellFilter& rhs)
+  {
+    if(!node.IsMap() || node.size() != 4)
+      return false;
+
+    rhs.radius(node["radius"].as<float>());
+    rhs.b(node["b"].as<float>());
+    rhs.c(node["c"].as<float>());
+    
+    return true;
+  }
+};
+
+YAML_NAMESPACE_END
+
+#endif
@@ -29,9 +29,44 @@ public:
     const size_t _size,
     std::vector< float >& _u,
     std::vector< float >& _v,
-    TextureSystem _texture_system
+    std::vector< float >& _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info
     );
 
+  /**
+   * @brief      Fault the texture tiles under a set of points into the cache without filtering
+   *
+   * @param[in]  _size            number of points
+   * @param[in]  _u               u texture coordinates
+   * @param[in]  _v               v texture coordinates
+   * @param[in]  _footprint       filter width in texture space
+   * @param[in]  _texture_system  texture system used for lookups
+   * @param[in]  _thread_info     per thread texture system information
+   */
+  void prefetch(
+    const size_t _size,
+    const float* _u,
+    const float* _v,
+    const float* _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info
+    ) const;
+
+  /**
+   * @brief      Register texture files for conversion into tiled and mip mapped files
+   *
+   * @param      _converter  converter run at scene load
+   */
+  void preconvert(TextureConverter* _converter);
+
+  /**
+   * @brief      Resolve texture handles once at scene load to avoid looking up files by name
+   *
+   * @param[in]  _texture_system  texture system used for lookups
+   */
+  void resolve(TextureSystem _texture_system);
+
   /**
    * @brief      Get probabilty of bsdf reflectance for russian roulette
    *
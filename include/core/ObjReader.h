@@ -0,0 +1,58 @@
+#ifndef _OBJREADER_H_
+#define _OBJREADER_H_
+
+#include <string>
+#include <vector>
+
+#include <core/Common.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Reads triangulated geometry from wavefront obj files in parallel
+ *
+ * The file is memory mapped and split into chunks aligned to line endings. Element counts are
+ * gathered for every chunk in parallel and prefix summed so that each chunk can then parse its
+ * lines straight into shared arrays, relative face indices are resolved against these offsets.
+ * Unique position, texture and normal index triples are found with a concurrent open addressing
+ * hash table and numbered in order of first occurrence, which keeps the output identical to a
+ * sequential reader. Positions are transformed as they are written so that the buffers can be
+ * handed to embree directly, while normals are packed into 32 bit octahedral form. Only vertex,
+ * texture, normal and face statements are read and polygons are triangulated as fans.
+ */
+class ObjReader
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  ObjReader(const std::string& _filename)
+   : m_filename(_filename)
+  {;}
+
+  /**
+   * @brief      Reads file into embree ready buffers
+   *
+   * @param[in]  _transform  transform applied to positions and normals
+   * @param      _positions  output positions of three floats followed by a single float of padding
+   * @param      _normals    output octahedral normals, empty when the file has none
+   * @param      _texcoords  output texture coordinates, empty when the file has none
+   * @param      _indices    output triangle indices
+   *
+   * @return     true if the file was read without error, outputs are left untouched otherwise
+   */
+  bool read(
+    const Affine3f& _transform,
+    std::vector< float >* _positions,
+    std::vector< uint32_t >* _normals,
+    std::vector< float >* _texcoords,
+    std::vector< unsigned int >* _indices
+    ) const;
+
+private:
+  std::string m_filename;
+};
+
+MSC_NAMESPACE_END
+
+#endif
@@ -10,7 +10,10 @@ MSC_NAMESPACE_BEGIN
  * 
  * This is a simple interface for using a object in a polymorphic sense. It only requires that
  * each inherited class be able to retrieve texture coordinates using a primitive identification
- * number and some barycentric coordinates.
+ * number and some barycentric coordinates. Objects that are instanced receive hits in their local
+ * space and so must also be able to bring geometric normals into world space. Shading ranges always
+ * belong to a single object, so attributes can also be interpolated for a whole range of hits in one
+ * call, reading structure of arrays inputs and writing structure of arrays outputs.
  */
 class ObjectInterface
 {
@@ -41,6 +44,66 @@ public:
     const float _t,
     Vector2f* _output
     ) const =0;
+
+  /**
+   * @brief      Gets texture density used to convert a world footprint into texture space
+   *
+   * @param[in]  _primitive  primitive index value
+   *
+   * @return     texture space length per unit of world space length
+   */
+  virtual float density(const size_t _primitive) const =0;
+
+  /**
+   * @brief      Interpolates texture coordinates and densities for a range of hits
+   *
+   * @param[in]  _size        number of hits
+   * @param[in]  _primitives  primitive index values
+   * @param[in]  _s           s coordinates
+   * @param[in]  _t           t coordinates
+   * @param      _u           output u texture coordinates
+   * @param      _v           output v texture coordinates
+   * @param      _density     output texture densities, skipped when null
+   */
+  virtual void interpolateTexcoords(
+    const size_t _size,
+    const int* _primitives,
+    const float* _s,
+    const float* _t,
+    float* _u,
+    float* _v,
+    float* _density
+    ) const =0;
+
+  /**
+   * @brief      Interpolates world space normals for a range of hits
+   *
+   * @param[in]  _size        number of hits
+   * @param[in]  _primitives  primitive index values
+   * @param[in]  _s           s coordinates
+   * @param[in]  _t           t coordinates
+   * @param      _x           output unnormalised x components
+   * @param      _y           output unnormalised y components
+   * @param      _z           output unnormalised z components
+   */
+  virtual void interpolateNormals(
+    const size_t _size,
+    const int* _primitives,
+    const float* _s,
+    const float* _t,
+    float* _x,
+    float* _y,
+    float* _z
+    ) const =0;
+
+  /**
+   * @brief      Transforms geometric normal returned by embree into world space
+   *
+   * @param[in]  _normal  geometric normal in object space
+   *
+   * @return     unnormalised normal in world space
+   */
+  virtual Vector3f worldNormal(const Vector3f& _normal) const =0;
 };
 
 MSC_NAMESPACE_END
@@ -11,9 +11,11 @@ MSC_NAMESPACE_BEGIN
 
 typedef OpenImageIO::ImageCache* ImageCache;
 typedef OpenImageIO::TextureSystem* TextureSystem;
-typedef tbb::enumerable_thread_specific< TextureSystem > LocalTextureSystem;
+typedef OpenImageIO::TextureSystem::Perthread* TexturePerthread;
+typedef OpenImageIO::TextureSystem::TextureHandle* TextureHandle;
+typedef tbb::enumerable_thread_specific< TexturePerthread > LocalTexturePerthread;
 
-inline TextureSystem nullTextureSystem()
+inline TexturePerthread nullTexturePerthread()
 {
   return NULL;
 }
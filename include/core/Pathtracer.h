@@ -5,6 +5,8 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <tbb/concurrent_queue.h>
 
 #include <core/Common.h>
@@ -15,14 +17,22 @@
 #include <core/Scene.h>
 #include <core/CameraInterface.h>
 #include <core/FilterInterface.h>
+#include <core/FilterTable.h>
 #include <core/SamplerInterface.h>
 #include <core/RayUncompressed.h>
 #include <core/RayCompressed.h>
 #include <core/RandomGenerator.h>
+#include <core/Contribution.h>
 #include <core/BatchItem.h>
+#include <core/Integrator.h>
 
 MSC_NAMESPACE_BEGIN
 
+class PolygonObject;
+class InstanceObject;
+class QuadLight;
+class Prefetch;
+
 /**
  * @brief      Rendering engine and interface to external programs
  * 
@@ -30,8 +40,16 @@ MSC_NAMESPACE_BEGIN
  * of the paper in a series of parallel and concurrent operations. Batch processing is done for
  * example while loading new data into a buffer from disk to avoid thread downtime. The system
  * can also render multiple images and combine the results iteratively for fast feedback or produce
- * images more efficiently using larger sample counts. Processing can also be queried and terminated
- * externally through the public methods.
+ * images more efficiently using larger sample counts. Primary rays are generated lazily a few tiles
+ * at a time whenever the rays in flight leave room within the ray budget. Being coherent, they are
+ * traced in packets and shaded directly rather than being written to the bins and sorted. Scenes are
+ * constructed as a set of tasks where meshes are read in parallel alongside texture preparation and
+ * the acceleration structure is then built in the background, so the first primary rays are created
+ * before it has finished. When scene updates are enabled objects and lights can be inserted, moved
+ * and removed between iterations, edits are committed together before rays are next traced and
+ * only the film is reset. With a geometry cache the meshes of a bundle are paged in as each sorted
+ * batch reaches them, so scenes larger than memory can be rendered. Processing can also be queried
+ * and terminated externally through the public methods.
  */
 class Pathtracer
 {
@@ -57,6 +75,14 @@ public:
    */
   void image(float** _pixels, int* _with, int* _height);
 
+  /**
+   * @brief      Converts tiles that have changed since the last call into an eight bit image
+   *
+   * @param      _image   eight bit rgb image matching the resolution
+   * @param      _tiles   will be set to the tiles that were updated
+   */
+  void preview(unsigned char* _image, std::vector< Tile >* _tiles);
+
   /**
    * @brief      Clear internal image data including samples and pixels
    */
@@ -74,6 +100,66 @@ public:
    */
   void terminate();
 
+  /**
+   * @brief      Check if an error threshold or sample budget has been set
+   *
+   * @return     adaptive state
+   */
+  bool adaptive();
+
+  /**
+   * @brief      Check if every tile is below the error threshold or the sample budget is spent
+   *
+   * @return     convergence state
+   */
+  bool converged();
+
+  /**
+   * @brief      Inserts polygon object into the scene, must not be called during an iteration
+   *
+   * @param[in]  _object  polygon object that has not been constructed
+   *
+   * @return     object id used for later edits
+   */
+  int insert(const PolygonObject& _object);
+
+  /**
+   * @brief      Inserts instance into the scene reusing meshes of the same file, must not be called
+   *             during an iteration
+   *
+   * @param[in]  _instance  instance object without a mesh
+   *
+   * @return     object id used for later edits
+   */
+  int insert(const InstanceObject& _instance);
+
+  /**
+   * @brief      Inserts light into the scene, must not be called during an iteration
+   *
+   * @param[in]  _light  quad light
+   *
+   * @return     object id of the light geometry used for later edits
+   */
+  int insert(const QuadLight& _light);
+
+  /**
+   * @brief      Moves object or instance to a new transform, must not be called during an iteration
+   *
+   * @param[in]  _object       object id
+   * @param[in]  _translation  translation vector
+   * @param[in]  _rotation     euler angle vector
+   * @param[in]  _scale        scale vector
+   */
+  void transform(const int _object, const Vector3f& _translation, const Vector3f& _rotation, const Vector3f& _scale);
+
+  /**
+   * @brief      Removes object, instance or light from the scene, must not be called during an iteration
+   *             and the last light cannot be removed
+   *
+   * @param[in]  _object  object id
+   */
+  void remove(const int _object);
+
   /**
    * @brief      Compute a single iteration of image
    *
@@ -88,24 +174,48 @@ private:
   boost::scoped_ptr< Scene > m_scene;
   boost::scoped_ptr< CameraInterface > m_camera;
   boost::scoped_ptr< FilterInterface > m_filter;
+  boost::scoped_ptr< FilterTable > m_filter_table;
   boost::scoped_ptr< SamplerInterface > m_sampler;
+  boost::scoped_ptr< Prefetch > m_prefetch;
+
+  TextureSystem m_texture_system;
+  LocalTexturePerthread m_thread_texture_info;
+  LocalContributions m_thread_contributions;
+  LocalDepthHistogram m_thread_histogram;
 
-  LocalTextureSystem m_thread_texture_system;
-  LocalRandomGenerator m_thread_random_generator;
+  std::vector< Contribution > m_contributions;
+  std::vector< Contribution > m_contributions_temp;
 
   tbb::concurrent_queue< BatchItem > m_batch_queue;
 
   boost::atomic< bool > m_terminate;
+  size_t m_sample_count;
+  size_t m_camera_tile;
+  std::vector< size_t > m_camera_offsets;
+  boost::mutex m_image_mutex;
+  boost::thread m_commit_thread;
+  bool m_commit_pending;
 
   void construct(const std::string &_filename);
+  void sceneCommit();
+  void sceneReady();
+  void sceneEditing();
+  void sceneChanged();
+  ObjectInterface* sceneObject(const int _object);
+  void sceneInsert(const unsigned int _geom_id, const boost::shared_ptr< ObjectInterface >& _object);
   void cameraSampling();
-  bool batchLoading(BatchItem* batch_info);
+  void cameraStreaming(RayUncompressed* _buffer, const size_t _capacity);
+  bool batchLoading(BatchItem* batch_info, RayUncompressed* batch_uncompressed, const size_t bin_size);
   void fileLoading(const BatchItem& batch_info, RayCompressed* batch_compressed);
   void rayDecompressing(const BatchItem& batch_info, RayCompressed* batch_compressed, RayUncompressed* batch_uncompressed);
   void raySorting(const BatchItem& batch_info, RayUncompressed* batch_uncompressed);
   void sceneTraversal(const BatchItem& batch_info, RayUncompressed* batch_uncompressed);
   void hitPointSorting(const BatchItem& batch_info, RayUncompressed* batch_uncompressed);
   void surfaceShading(const BatchItem& batch_info, RayUncompressed* batch_uncompressed);
+  void sampleAccumulation();
+  void textureStatistics();
+  void geometryStatistics();
+  void pathStatistics();
   void imageConvolution();
 };
 
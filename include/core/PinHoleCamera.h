@@ -77,10 +77,10 @@ public:
    *
    * @param[in]  _count      sample count to process
    * @param      _positions  positions on film plane of samples
-   * @param      _random     thread local random generator to prevent mutation
+   * @param      _lens       positions on the unit square used to sample the lens
    * @param      _ouput      output of compressed rays
    */
-  void sample(const int _count, float* _positions, RandomGenerator* _random, RayCompressed* _ouput) const;
+  void sample(const int _count, float* _positions, float* _lens, RayCompressed* _ouput) const;
 
 private:
   Vector3f m_translation;
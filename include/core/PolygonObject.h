@@ -5,11 +5,12 @@
 #include <vector>
 #include <iostream>
 
-#include <tinyobjloader/tiny_obj_loader.h>
+#include <boost/shared_ptr.hpp>
 
 #include <core/Common.h>
 #include <core/ObjectInterface.h>
 #include <core/Singleton.h>
+#include <core/SceneBundle.h>
 
 MSC_NAMESPACE_BEGIN
 
@@ -18,7 +19,11 @@ MSC_NAMESPACE_BEGIN
  * 
  * This is polygon geometric type and store local geometry data such as positions, normals, texture
  * coordinates and face indices. It also allows access to this data based upon a primitive
- * identification number and some barycentric coordinates.
+ * identification number and some barycentric coordinates. Geometry is either read from the object
+ * file and owned by the object or mapped from a precompiled scene bundle, so it is accessed through
+ * pointers that are set once the object has been constructed or mapped. Attributes are kept compact
+ * and decoded on access, positions are stored as three floats, normals in 32 bit octahedral form and
+ * texture coordinates as 16 bit units across their range when it spans no more than one tile.
  */
 class PolygonObject : public ObjectInterface
 {
@@ -30,8 +35,33 @@ public:
     : m_translation(Vector3f(0.f, 0.f, 0.f))
     , m_rotation(Vector3f(0.f, 0.f, 0.f))
     , m_scale(Vector3f(1.f, 1.f, 1.f))
+    , m_position_data(NULL)
+    , m_normal_data(NULL)
+    , m_texcoord_data(NULL)
+    , m_texcoord_unit_data(NULL)
+    , m_index_data(NULL)
+    , m_texcoord_lower(Vector2f(0.f, 0.f))
+    , m_texcoord_extent(Vector2f(0.f, 0.f))
+    , m_vertex_count(0)
+    , m_triangle_count(0)
   {;}
 
+  /**
+   * @brief      Copy constructor, geometry held by the object is copied and viewed again
+   *
+   * @param[in]  _other  object to copy
+   */
+  PolygonObject(const PolygonObject& _other);
+
+  /**
+   * @brief      Assignment operator, geometry held by the object is copied and viewed again
+   *
+   * @param[in]  _other  object to copy
+   *
+   * @return     this object
+   */
+  PolygonObject& operator=(const PolygonObject& _other);
+
   /**
    * @brief      Getter method for filename
    *
@@ -68,18 +98,67 @@ public:
   inline int shader() const {return m_shader;}
 
   /**
-   * @brief      Get reference to geometry positions
+   * @brief      Get geometry positions of three floats followed by a single float of padding
    *
-   * @return     positions reference
+   * @return     positions pointer
    */
-  inline std::vector<float>& positions() {return m_positions;}
+  inline const float* positions() const {return m_position_data;}
 
   /**
-   * @brief      Get reference to geometry indices
+   * @brief      Get geometry normals in octahedral form
    *
-   * @return     indices reference
+   * @return     normals pointer or null if there are none
    */
-  inline std::vector<unsigned int>& indices() {return m_indices;}
+  inline const uint32_t* normals() const {return m_normal_data;}
+
+  /**
+   * @brief      Get geometry texture coordinates stored as floats
+   *
+   * @return     texture coordinates pointer or null if there are none or they are stored as units
+   */
+  inline const float* texcoords() const {return m_texcoord_data;}
+
+  /**
+   * @brief      Get geometry texture coordinates stored as 16 bit units across their range
+   *
+   * @return     texture units pointer or null if there are none or they are stored as floats
+   */
+  inline const uint16_t* texcoordUnits() const {return m_texcoord_unit_data;}
+
+  /**
+   * @brief      Getter method for lower bound of texture units
+   *
+   * @return     texture coordinates of unit zero
+   */
+  inline Vector2f texcoordLower() const {return m_texcoord_lower;}
+
+  /**
+   * @brief      Getter method for range of texture units
+   *
+   * @return     texture coordinate range covered by the units
+   */
+  inline Vector2f texcoordExtent() const {return m_texcoord_extent;}
+
+  /**
+   * @brief      Get geometry indices
+   *
+   * @return     indices pointer
+   */
+  inline const unsigned int* indices() const {return m_index_data;}
+
+  /**
+   * @brief      Getter method for vertex count
+   *
+   * @return     number of vertices
+   */
+  inline size_t vertices() const {return m_vertex_count;}
+
+  /**
+   * @brief      Getter method for triangle count
+   *
+   * @return     number of triangles
+   */
+  inline size_t triangles() const {return m_triangle_count;}
 
   /**
    * @brief      Setter method for filename
@@ -121,6 +200,26 @@ public:
    */
   void construct();
 
+  /**
+   * @brief      Uses transformed geometry from a precompiled bundle instead of the object file
+   *
+   * @param[in]  _bundle  scene bundle that is kept mapped for the lifetime of the object
+   * @param[in]  _mesh    index of the object within the bundle
+   */
+  void map(const boost::shared_ptr< SceneBundle >& _bundle, const size_t _mesh);
+
+  /**
+   * @brief      Moves constructed geometry to a new transform, mapped geometry is copied first
+   *
+   * Positions and normals are computed again from the ones held before the first move, so repeated
+   * moves do not accumulate rounding or quantisation error.
+   *
+   * @param[in]  _translation  translation vector
+   * @param[in]  _rotation     euler angle vector
+   * @param[in]  _scale        scale vector
+   */
+  void transform(const Vector3f& _translation, const Vector3f& _rotation, const Vector3f& _scale);
+
   /**
    * @brief      Gets u and v texture coordinates
    *
@@ -136,6 +235,102 @@ public:
     Vector2f* _output
     ) const;
 
+  /**
+   * @brief      Gets texture density used to convert a world footprint into texture space
+   *
+   * @param[in]  _primitive  primitive index value
+   *
+   * @return     texture space length per unit of world space length
+   */
+  float density(const size_t _primitive) const;
+
+  /**
+   * @brief      Gets texture density once the geometry is placed with a linear transform
+   *
+   * @param[in]  _primitive  primitive index value
+   * @param[in]  _linear     linear part of the transform placing the geometry
+   *
+   * @return     texture space length per unit of world space length
+   */
+  float density(const size_t _primitive, const Eigen::Matrix3f& _linear) const;
+
+  /**
+   * @brief      Interpolates texture coordinates and densities for a range of hits, meshes without
+   *             texture coordinates give zeros
+   *
+   * @param[in]  _size        number of hits
+   * @param[in]  _primitives  primitive index values
+   * @param[in]  _s           s coordinates
+   * @param[in]  _t           t coordinates
+   * @param      _u           output u texture coordinates
+   * @param      _v           output v texture coordinates
+   * @param      _density     output texture densities, skipped when null
+   */
+  void interpolateTexcoords(
+    const size_t _size,
+    const int* _primitives,
+    const float* _s,
+    const float* _t,
+    float* _u,
+    float* _v,
+    float* _density
+    ) const;
+
+  /**
+   * @brief      Interpolates texture coordinates and densities once the geometry is placed with a
+   *             linear transform, meshes without texture coordinates give zeros
+   *
+   * @param[in]  _size        number of hits
+   * @param[in]  _primitives  primitive index values
+   * @param[in]  _s           s coordinates
+   * @param[in]  _t           t coordinates
+   * @param[in]  _linear      linear part of the transform placing the geometry
+   * @param      _u           output u texture coordinates
+   * @param      _v           output v texture coordinates
+   * @param      _density     output texture densities, skipped when null
+   */
+  void interpolateTexcoords(
+    const size_t _size,
+    const int* _primitives,
+    const float* _s,
+    const float* _t,
+    const Eigen::Matrix3f& _linear,
+    float* _u,
+    float* _v,
+    float* _density
+    ) const;
+
+  /**
+   * @brief      Interpolates normals for a range of hits, meshes without normals give the geometric
+   *             normal of each triangle
+   *
+   * @param[in]  _size        number of hits
+   * @param[in]  _primitives  primitive index values
+   * @param[in]  _s           s coordinates
+   * @param[in]  _t           t coordinates
+   * @param      _x           output unnormalised x components
+   * @param      _y           output unnormalised y components
+   * @param      _z           output unnormalised z components
+   */
+  void interpolateNormals(
+    const size_t _size,
+    const int* _primitives,
+    const float* _s,
+    const float* _t,
+    float* _x,
+    float* _y,
+    float* _z
+    ) const;
+
+  /**
+   * @brief      Geometry is stored in world space so normals are returned unchanged
+   *
+   * @param[in]  _normal  geometric normal
+   *
+   * @return     geometric normal
+   */
+  inline Vector3f worldNormal(const Vector3f& _normal) const {return _normal;}
+
   /**
    * @brief      Gets normal direction
    *
@@ -159,9 +354,44 @@ private:
   int m_shader;
 
   std::vector< float > m_positions;
-  std::vector< float > m_normals;
+  std::vector< uint32_t > m_normals;
   std::vector< float > m_texcoords;
+  std::vector< uint16_t > m_texcoord_units;
   std::vector< unsigned int > m_indices;
+  std::vector< float > m_source_positions;
+  std::vector< uint32_t > m_source_normals;
+  Affine3f m_source_placement;
+
+  const float* m_position_data;
+  const uint32_t* m_normal_data;
+  const float* m_texcoord_data;
+  const uint16_t* m_texcoord_unit_data;
+  const unsigned int* m_index_data;
+  Vector2f m_texcoord_lower;
+  Vector2f m_texcoord_extent;
+  size_t m_vertex_count;
+  size_t m_triangle_count;
+  boost::shared_ptr< SceneBundle > m_bundle;
+
+  inline Vector3f position(const size_t _vertex) const
+  {
+    return Vector3f(m_position_data[3 * _vertex + 0], m_position_data[3 * _vertex + 1], m_position_data[3 * _vertex + 2]);
+  }
+
+  inline Vector2f texcoord(const size_t _vertex) const
+  {
+    if(m_texcoord_unit_data == NULL)
+      return Vector2f(m_texcoord_data[2 * _vertex + 0], m_texcoord_data[2 * _vertex + 1]);
+
+    return Vector2f(
+      m_texcoord_lower.x() + m_texcoord_extent.x() * (m_texcoord_unit_data[2 * _vertex + 0] / 65535.f),
+      m_texcoord_lower.y() + m_texcoord_extent.y() * (m_texcoord_unit_data[2 * _vertex + 1] / 65535.f)
+      );
+  }
+
+  void compact();
+  void view();
+  Affine3f placement() const;
 };
 
 MSC_NAMESPACE_END
@@ -182,8 +412,6 @@ template<> struct convert<msc::PolygonObject>
     rhs.scale(node["scale"].as<msc::Vector3f>());
     rhs.shader(node["shader"].as<int>());
 
-    rhs.construct();
-
     return true;
   }
 };
@@ -0,0 +1,92 @@
+#ifndef _PREFETCH_H_
+#define _PREFETCH_H_
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/scoped_array.hpp>
+
+#include <core/Common.h>
+#include <core/OpenImageWrapper.h>
+#include <core/Scene.h>
+#include <core/Settings.h>
+#include <core/RayUncompressed.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Loads texture tiles for sorted hit points ahead of surface shading
+ *
+ * Once hit points have been sorted the texture coordinates of every shading range are known before
+ * shading begins. The batch is divided into the same ranges of equal geometry as the integrator
+ * and a small number of threads, kept alive across batches, walk them from the middle of the batch
+ * onwards while the tbb workers shade from the start. Shading marks each range as it begins so the
+ * threads skip any range it has already reached. Only one unfiltered texel is looked up for every
+ * texture tile a range covers, which faults the tile into the shared cache so that misses overlap
+ * with shading rather than stalling the tbb workers.
+ */
+class Prefetch
+{
+public:
+  /**
+   * @brief      Initialiser list for class, starts the prefetch threads
+   *
+   * @param      _scene           scene holding objects and shaders
+   * @param      _settings        settings giving the shading size and thread count
+   * @param[in]  _texture_system  texture system used for lookups
+   */
+  Prefetch(Scene* _scene, Settings* _settings, TextureSystem _texture_system);
+
+  /**
+   * @brief      Stops and joins the prefetch threads
+   */
+  ~Prefetch();
+
+  /**
+   * @brief      Starts prefetching a sorted batch that is about to be shaded
+   *
+   * @param      _batch  sorted hit points
+   * @param[in]  _size   number of hit points
+   */
+  void begin(RayUncompressed* _batch, const size_t _size);
+
+  /**
+   * @brief      Marks the range starting at a hit point as reached by shading, thread safe
+   *
+   * @param[in]  _begin  first hit point of the range
+   */
+  void shading(const size_t _begin);
+
+  /**
+   * @brief      Stops prefetching the batch and waits until no thread reads it any longer
+   */
+  void end();
+
+private:
+  Scene* m_scene;
+  Settings* m_settings;
+  TextureSystem m_texture_system;
+
+  RayUncompressed* m_batch;
+  std::vector< size_t > m_ranges;
+  boost::scoped_array< boost::atomic< bool > > m_shaded;
+  size_t m_shaded_size;
+  size_t m_first;
+  boost::atomic< size_t > m_claimed;
+
+  boost::thread_group m_threads;
+  boost::mutex m_mutex;
+  boost::condition_variable m_condition;
+  size_t m_generation;
+  size_t m_active;
+  boost::atomic< bool > m_cancel;
+  bool m_stop;
+
+  void worker();
+  void run(TexturePerthread _texture_info);
+};
+
+MSC_NAMESPACE_END
+
+#endif
@@ -1,42 +1,124 @@
 #ifndef _RANDOMGENERATOR_H_
 #define _RANDOMGENERATOR_H_
 
-#include <boost/random.hpp>
-#include <tbb/enumerable_thread_specific.h>
+#include <boost/cstdint.hpp>
 
 #include <core/Common.h>
+#include <core/Sequence.h>
 
 MSC_NAMESPACE_BEGIN
 
 /**
- * @brief      A uniform random generator
+ * @brief      Dimensions allocated to each path vertex within its sequence
+ */
+enum PathDimension
+{
+  DIMENSION_LIGHT_PICK = 0,
+  DIMENSION_LIGHT = 2,
+  DIMENSION_CONTINUATION = 4,
+  DIMENSION_BSDF = 6,
+  DIMENSION_LENS = 8
+};
+
+/**
+ * @brief      Key for the sequence of a path vertex
+ *
+ * @param[in]  _pixel  pixel index
+ * @param[in]  _depth  ray depth of the vertex
+ *
+ * @return     key value
+ */
+inline boost::uint64_t pathKey(const size_t _pixel, const size_t _depth)
+{
+  return (boost::uint64_t(_depth) << 40) ^ boost::uint64_t(_pixel);
+}
+
+/**
+ * @brief      A counter based uniform random generator
  * 
- * This random generator uses boost's mersenne twister algorithm and a uniform distribution to
- * produce float values between zero and one. Local copies are created for each thread and passed
- * to scene objects to prevent mutation of shared data.
+ * Rather than advancing a shared state this generator hashes a key together with a counter, so
+ * a stream is fully determined by its key. It can also draw from an Owen scrambled Sobol sequence
+ * where the counter selects the dimension, which path vertices use with one sequence per pixel and
+ * depth indexed by sample and iteration. In both cases renders are reproducible regardless of
+ * thread count or scheduling and no thread local storage is needed.
  */
 class RandomGenerator
 {
 public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  RandomGenerator()
+   : m_key(mixBits(0))
+   , m_index(0)
+   , m_counter(0)
+   , m_sequence(false)
+  {;}
+
   /**
    * @brief      Creates a uniform random number between 0 and 1 
    *
    * @return     random number
    */
-  float sample();
+  inline float sample()
+  {
+    return m_sequence ? sequenceSample(m_key, m_index, m_counter++) : uniformSample(m_key, m_counter++);
+  }
+
+  /**
+   * @brief      Creates an array of uniform random numbers between 0 and 1
+   *
+   * @param[in]  _count   number of values
+   * @param      _output  output values
+   */
+  void sample(const size_t _count, float* _output);
+
+  /**
+   * @brief      Creates random bits for seeding scrambles
+   *
+   * @return     random bits
+   */
+  inline boost::uint32_t bits()
+  {
+    return static_cast< boost::uint32_t >(mixBits(m_key + (boost::uint64_t(m_counter++) + 1) * 0x9E3779B97F4A7C15ULL) >> 32);
+  }
 
   /**
    * @brief      Overload so that class can be used with std::generate
    */
   inline float operator()(){return this->sample();}
 
+  /**
+   * @brief      Reset the generator to a known stream
+   *
+   * @param[in]  _seed       stream key
+   * @param[in]  _dimension  first dimension of stream to use
+   */
+  void seed(const boost::uint64_t _seed, const boost::uint32_t _dimension = 0);
+
+  /**
+   * @brief      Reset the generator to a point of a low discrepancy sequence
+   *
+   * @param[in]  _seed       sequence key
+   * @param[in]  _index      sequence index
+   * @param[in]  _dimension  first dimension to use
+   */
+  void sequence(const boost::uint64_t _seed, const boost::uint32_t _index, const boost::uint32_t _dimension = 0);
+
+  /**
+   * @brief      Move to a dimension allocated for a particular use
+   *
+   * @param[in]  _dimension  next dimension to use
+   */
+  inline void dimension(const boost::uint32_t _dimension) {m_counter = _dimension;}
+
 private:
-  boost::mt19937 m_generator;
-  boost::uniform_real<float> m_uniform_dist;
+  boost::uint64_t m_key;
+  boost::uint32_t m_index;
+  boost::uint32_t m_counter;
+  bool m_sequence;
 };
 
-typedef tbb::enumerable_thread_specific< RandomGenerator > LocalRandomGenerator;
-
 MSC_NAMESPACE_END
 
 #endif
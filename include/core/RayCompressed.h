@@ -10,6 +10,7 @@ MSC_NAMESPACE_BEGIN
  * 
  * Minimal data required to store a ray that also represents the last segment of a light path within
  * a scene. This has a direct impact on the size of each batch and as result read/write performance.
+ * The cone width and spread approximate the ray footprint for filtered texture lookups.
  */
 struct RayCompressed
 {
@@ -18,6 +19,8 @@ struct RayCompressed
 
   float weight[3];
   float lastPdf;
+  float coneWidth;
+  float coneSpread;
   int rayDepth;
   int sampleID;
 };
@@ -9,6 +9,37 @@
 
 MSC_NAMESPACE_BEGIN
 
+/**
+ * @brief      Decompress a single ray ready for traversal
+ *
+ * @param[in]  _input   compressed ray
+ * @param      _output  uncompressed ray
+ */
+inline void decompress(const RayCompressed& _input, RayUncompressed* _output)
+{
+  _output->org[0] = _input.org[0];
+  _output->org[1] = _input.org[1];
+  _output->org[2] = _input.org[2];
+  _output->dir[0] = _input.dir[0];
+  _output->dir[1] = _input.dir[1];
+  _output->dir[2] = _input.dir[2];
+  _output->tnear = 0.001f;
+  _output->tfar = 100000.f;
+  _output->geomID = RTC_INVALID_GEOMETRY_ID;
+  _output->primID = RTC_INVALID_GEOMETRY_ID;
+  _output->instID = RTC_INVALID_GEOMETRY_ID;
+  _output->mask = 0xFFFFFFFF;
+  _output->time = 0.f;
+  _output->weight[0] = _input.weight[0];
+  _output->weight[1] = _input.weight[1];
+  _output->weight[2] = _input.weight[2];
+  _output->lastPdf = _input.lastPdf;
+  _output->coneWidth = _input.coneWidth;
+  _output->coneSpread = _input.coneSpread;
+  _output->rayDepth = _input.rayDepth;
+  _output->sampleID = _input.sampleID;
+}
+
 /**
  * @brief      Functor class to decompress an array of rays
  * 
@@ -0,0 +1,44 @@
+#ifndef _RAYPACKET_H_
+#define _RAYPACKET_H_
+
+#include <tbb/tbb.h>
+
+#include <core/Common.h>
+#include <core/Scene.h>
+#include <core/RayUncompressed.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Functor class to intersect coherent rays with scene geometry in packets
+ * 
+ * Primary rays of a tile share an origin and have similar directions, so they are gathered into
+ * packets of four and traced together using Embree's packet interface. Hit data is then scattered
+ * back so that the rays can be sorted and shaded like any other batch.
+ */
+class RayPacket
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  RayPacket(Scene* _scene, RayUncompressed* _data)
+   : m_scene(_scene)
+   , m_data(_data)
+  {;}
+
+  /**
+   * @brief      Operator overloader to allow the class to act as a functor with tbb
+   * 
+   * @param[in]  r           a one dimensional range over an array of rays
+   */
+  void operator()(const tbb::blocked_range< size_t >& r) const;
+
+private:
+  Scene* m_scene;
+  RayUncompressed* m_data;
+};
+
+MSC_NAMESPACE_END
+
+#endif
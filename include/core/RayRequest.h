@@ -0,0 +1,43 @@
+#ifndef _RAYREQUEST_H_
+#define _RAYREQUEST_H_
+
+#include <tbb/tbb.h>
+
+#include <core/Common.h>
+#include <core/Scene.h>
+#include <core/RayUncompressed.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Functor class to request paged geometry that rays may reach
+ * 
+ * Rays of a sorted batch are traversed across the bounding proxies of paged geometry using tbb so
+ * that every mesh the batch needs can be built before it is traced.
+ */
+class RayRequest
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  RayRequest(Scene* _scene, RayUncompressed* _data)
+   : m_scene(_scene)
+   , m_data(_data)
+  {;}
+
+  /**
+   * @brief      Operator overloader to allow the class to act as a functor with tbb
+   * 
+   * @param[in]  r           a one dimensional range over an array of rays
+   */
+  void operator()(const tbb::blocked_range< size_t >& r) const;
+
+private:
+  Scene* m_scene;
+  RayUncompressed* m_data;
+};
+
+MSC_NAMESPACE_END
+
+#endif
\ No newline at end of file
@@ -10,7 +10,8 @@ MSC_NAMESPACE_BEGIN
  * @brief      Structure to contain a uncompressed ray
  * 
  * Uncompressed rays are an extension of Embree's ray type to support path tracing and are also used
- * for hit point sorting to minimise usage on memory.
+ * for hit point sorting to minimise usage on memory. The shading key is only written when hit points
+ * are sorted for texture coherence.
  */
 struct RayUncompressed
 {
@@ -48,8 +49,11 @@ struct RayUncompressed
   //Added data
   float weight[3];
   float lastPdf;
+  float coneWidth;
+  float coneSpread;
   int rayDepth;
   int sampleID;
+  unsigned int shadingKey;
 };
 
 inline bool operator==(const RayUncompressed &lhs, const RayUncompressed &rhs)
@@ -68,6 +72,23 @@ struct CompareHit
   }
 };
 
+/**
+ * @brief      Comparison functor for uncompressed rays based on hit geometry, shading key and primative id
+ */
+struct CompareShading
+{
+  bool operator()(const RayUncompressed &lhs, const RayUncompressed &rhs) const
+  {
+    if(lhs.geomID != rhs.geomID)
+      return lhs.geomID < rhs.geomID;
+
+    if(lhs.shadingKey != rhs.shadingKey)
+      return lhs.shadingKey < rhs.shadingKey;
+
+    return lhs.primID < rhs.primID;
+  }
+};
+
 /**
  * @brief      Comparison functor for uncompressed rays based on position
  */
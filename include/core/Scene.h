@@ -1,6 +1,7 @@
 #ifndef _SCENE_H_
 #define _SCENE_H_
 
+#include <string>
 #include <vector>
 #include <map>
 
@@ -8,7 +9,9 @@
 
 #include <core/Common.h>
 #include <core/EmbreeWrapper.h>
+#include <core/GeometryCache.h>
 #include <core/ObjectInterface.h>
+#include <core/PolygonObject.h>
 #include <core/ShaderInterface.h>
 #include <core/LightInterface.h>
 
@@ -20,17 +23,28 @@ MSC_NAMESPACE_BEGIN
  * The scene structure contains std::vectors of polymorphic pointers to implemented objects on
  * the heap. Smart pointers are used to manage memory and there is also a map that represents the
  * relationship between shaders and lights. The RTCScene is the acceleration structure used by
- * Embree to traverse rays across geometry stored in the objects vector. The scene should not mutate
- * after initial construction.
+ * Embree to traverse rays across geometry stored in the objects vector. Instanced geometry is held
+ * in its own scenes, one per unique file, which are referenced by the instances of the main scene.
+ * The shared meshes are looked up by filename so that instances added later reuse them.
+ * Hits on instances are resolved to the instance so that geometry ids always index the objects
+ * vector, removed objects leave an empty entry behind. The shaders of removed lights are listed as
+ * free and reused by the next light inserted. The scene should only be edited through the
+ * pathtracer once constructed. When geometry is paged the RTCScene holds bounding proxies and the
+ * lights instead, and rays are traced through the geometry cache.
  */
 struct Scene
 {
   RTCScene rtc_scene;
+  std::vector< RTCScene > rtc_meshes;
+  std::vector< boost::shared_ptr< PolygonObject > > meshes;
+  std::map< std::string, size_t > mesh_files;
+  boost::shared_ptr< GeometryCache > geometry_cache;
 
   std::vector< boost::shared_ptr< ObjectInterface > > objects;
   std::vector< boost::shared_ptr< ShaderInterface > > shaders;
   std::vector< boost::shared_ptr< LightInterface > > lights;
   std::map< int, int > shaders_to_lights;
+  std::vector< int > free_shaders;
 };
 
 MSC_NAMESPACE_END
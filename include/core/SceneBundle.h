@@ -0,0 +1,128 @@
+#ifndef _SCENEBUNDLE_H_
+#define _SCENEBUNDLE_H_
+
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <core/Common.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Location of one polygon object's arrays within a scene bundle
+ *
+ * Offsets are in bytes from the start of the bundle and sizes count elements rather than bytes. The
+ * bounds of the positions are stored so geometry can be placed without reading it. Texture
+ * coordinates are either 32 bit floats or 16 bit units across the stored range.
+ */
+struct BundleMesh
+{
+  boost::uint64_t positions_offset;
+  boost::uint64_t positions_size;
+  boost::uint64_t normals_offset;
+  boost::uint64_t normals_size;
+  boost::uint64_t texcoords_offset;
+  boost::uint64_t texcoords_size;
+  boost::uint64_t indices_offset;
+  boost::uint64_t indices_size;
+  float lower[3];
+  float upper[3];
+  float texcoord_lower[2];
+  float texcoord_extent[2];
+  boost::uint32_t texcoord_bits;
+};
+
+/**
+ * @brief      Precompiled scene stored as a single memory mapped file
+ *
+ * A bundle holds the scene description along with the transformed geometry of every polygon object
+ * in the order they appear within the scene. Settings, shaders, lights and texture references are
+ * kept as the original description since decoding them is cheap, whereas the arrays are laid out
+ * with the padding and alignment that embree expects. Loading a bundle therefore only maps the file
+ * and hands the arrays to embree without parsing or copying geometry. The format is versioned and
+ * bundles written by a different version are rejected so they can be compiled again.
+ */
+class SceneBundle
+{
+public:
+  /**
+   * @brief      Maps bundle and validates its header, throws runtime error on failure
+   *
+   * @param[in]  _filename  bundle file path
+   */
+  SceneBundle(const std::string& _filename);
+
+  /**
+   * @brief      Checks whether a file starts with the bundle identifier
+   *
+   * @param[in]  _filename  file path
+   *
+   * @return     true if file is a bundle
+   */
+  static bool identify(const std::string& _filename);
+
+  /**
+   * @brief      Compiles scene description and its geometry into a bundle, throws runtime error on failure
+   *
+   * @param[in]  _scene   scene description file path
+   * @param[in]  _bundle  output bundle file path
+   */
+  static void compile(const std::string& _scene, const std::string& _bundle);
+
+  /**
+   * @brief      Getter method for scene description
+   *
+   * @return     yaml document string
+   */
+  std::string document() const;
+
+  /**
+   * @brief      Getter method for directory of original scene used to resolve relative paths
+   *
+   * @return     directory string
+   */
+  std::string directory() const;
+
+  /**
+   * @brief      Getter method for number of polygon objects
+   *
+   * @return     mesh count
+   */
+  size_t meshes() const;
+
+  /**
+   * @brief      Getter method for mesh layout
+   *
+   * @param[in]  _index  polygon object index in order of appearance
+   *
+   * @return     mesh layout
+   */
+  const BundleMesh& mesh(const size_t _index) const;
+
+  /**
+   * @brief      Releases resident pages of a mesh, which are read from the file again when touched
+   *
+   * @param[in]  _index  polygon object index in order of appearance
+   */
+  void release(const size_t _index) const;
+
+  /**
+   * @brief      Gets pointer into mapped bundle
+   *
+   * @param[in]  _offset  offset in bytes
+   *
+   * @return     pointer to mapped data
+   */
+  inline const char* data(const boost::uint64_t _offset) const {return m_file.data() + _offset;}
+
+private:
+  boost::iostreams::mapped_file_source m_file;
+  const BundleMesh* m_meshes;
+  size_t m_mesh_count;
+};
+
+MSC_NAMESPACE_END
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef _SEQUENCE_H_
+#define _SEQUENCE_H_
+
+#include <boost/cstdint.hpp>
+
+#include <core/Common.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Mix bits of a 64 bit value using the splitmix finalizer
+ *
+ * @param[in]  _value  input value
+ *
+ * @return     mixed value
+ */
+inline boost::uint64_t mixBits(boost::uint64_t _value)
+{
+  _value = (_value ^ (_value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  _value = (_value ^ (_value >> 27)) * 0x94D049BB133111EBULL;
+  return _value ^ (_value >> 31);
+}
+
+/**
+ * @brief      Stateless uniform random number for a key and dimension
+ * 
+ * As the result only depends on its arguments it can be evaluated for many dimensions or keys at
+ * once in vectorised loops.
+ *
+ * @param[in]  _key        hashed stream key
+ * @param[in]  _dimension  index within stream
+ *
+ * @return     random number between 0 and 1
+ */
+inline float uniformSample(const boost::uint64_t _key, const boost::uint32_t _dimension)
+{
+  boost::uint64_t bits = mixBits(_key + (boost::uint64_t(_dimension) + 1) * 0x9E3779B97F4A7C15ULL);
+  return static_cast< float >(bits >> 40) * (1.f / 16777216.f);
+}
+
+/**
+ * @brief      Reverse the order of bits
+ *
+ * @param[in]  _value  input value
+ *
+ * @return     reversed value
+ */
+inline boost::uint32_t reverseBits(boost::uint32_t _value)
+{
+  _value = ((_value >> 1) & 0x55555555u) | ((_value & 0x55555555u) << 1);
+  _value = ((_value >> 2) & 0x33333333u) | ((_value & 0x33333333u) << 2);
+  _value = ((_value >> 4) & 0x0F0F0F0Fu) | ((_value & 0x0F0F0F0Fu) << 4);
+  _value = ((_value >> 8) & 0x00FF00FFu) | ((_value & 0x00FF00FFu) << 8);
+  return (_value >> 16) | (_value << 16);
+}
+
+/**
+ * @brief      Nested uniform scramble of a fixed point value
+ * 
+ * This is the hash based Owen scramble described by Burley, where a Laine-Karras style permutation
+ * applied to the reversed bits only lets each bit be flipped by the bits above it.
+ *
+ * @param[in]  _value  fixed point value
+ * @param[in]  _seed   scramble seed
+ *
+ * @return     scrambled value
+ */
+inline boost::uint32_t owenScramble(boost::uint32_t _value, const boost::uint32_t _seed)
+{
+  _value = reverseBits(_value);
+  _value += _seed;
+  _value ^= _value * 0x6C50B47Cu;
+  _value ^= _value * 0xB82F1E52u;
+  _value ^= _value * 0xC7AFE638u;
+  _value ^= _value * 0x8D22F6E6u;
+  return reverseBits(_value);
+}
+
+/**
+ * @brief      First two dimensions of the Sobol sequence as fixed point values
+ *
+ * @param[in]  _index      sequence index
+ * @param[in]  _dimension  zero or one
+ *
+ * @return     fixed point value
+ */
+inline boost::uint32_t sobol(boost::uint32_t _index, const boost::uint32_t _dimension)
+{
+  if(_dimension == 0)
+    return reverseBits(_index);
+
+  boost::uint32_t result = 0;
+  for(boost::uint32_t direction = 0x80000000u; _index != 0; _index >>= 1, direction ^= direction >> 1)
+  {
+    if(_index & 1)
+      result ^= direction;
+  }
+
+  return result;
+}
+
+/**
+ * @brief      Owen scrambled Sobol sample padded across any number of dimensions
+ * 
+ * Dimensions are taken in pairs from the two dimensional Sobol sequence, where each pair shuffles
+ * the sequence index and scrambles the values with its own seeds. Pairs are therefore stratified
+ * in two dimensions and decorrelated from each other, which allows an unbounded number of path
+ * dimensions without a table of direction numbers.
+ *
+ * @param[in]  _key        hashed sequence key
+ * @param[in]  _index      sequence index
+ * @param[in]  _dimension  dimension
+ *
+ * @return     sample between 0 and 1
+ */
+inline float sequenceSample(const boost::uint64_t _key, const boost::uint32_t _index, const boost::uint32_t _dimension)
+{
+  boost::uint64_t seed = mixBits(_key + (boost::uint64_t(_dimension >> 1) + 1) * 0x9E3779B97F4A7C15ULL);
+
+  boost::uint32_t index = owenScramble(_index, static_cast< boost::uint32_t >(seed));
+  boost::uint32_t value = sobol(index, _dimension & 1);
+  value = owenScramble(value, static_cast< boost::uint32_t >(mixBits(seed + (_dimension & 1)) >> 32));
+
+  return static_cast< float >(value >> 8) * (1.f / 16777216.f);
+}
+
+/**
+ * @brief      Batch of consecutive two dimensional sequence samples
+ *
+ * @param[in]  _key        hashed sequence key
+ * @param[in]  _index      first sequence index
+ * @param[in]  _dimension  first dimension of the pair
+ * @param[in]  _count      number of samples
+ * @param      _output     interleaved output pairs
+ */
+inline void sequenceSamples(
+  const boost::uint64_t _key,
+  const boost::uint32_t _index,
+  const boost::uint32_t _dimension,
+  const size_t _count,
+  float* _output
+  )
+{
+  for(size_t index = 0; index < _count; ++index)
+  {
+    _output[2 * index + 0] = sequenceSample(_key, _index + index, _dimension);
+    _output[2 * index + 1] = sequenceSample(_key, _index + index, _dimension + 1);
+  }
+}
+
+MSC_NAMESPACE_END
+
+#endif
@@ -1,26 +1,180 @@
 #ifndef _SETTINGS_H_
 #define _SETTINGS_H_
 
+#include <string>
+
 #include <core/Common.h>
 
 MSC_NAMESPACE_BEGIN
 
+/**
+ * @brief      Acceleration structure build profile
+ *
+ * The standard profile balances build and trace time. The fast profile uses the quicker builders
+ * meant for dynamic scenes and suits interactive look development, while the quality profile
+ * spends longer building a tree that traces faster for final frames. The compact profile reduces
+ * memory for very large scenes and the robust profile avoids missed hits along shared edges at a
+ * cost in performance.
+ */
+enum BvhProfile
+{
+  BVH_STANDARD,
+  BVH_FAST,
+  BVH_QUALITY,
+  BVH_COMPACT,
+  BVH_ROBUST
+};
+
 /**
  * @brief      Structure of settings information
  * 
  * The settings that are read from the scene file are stored here and mostly address limits on ray
  * depth when rendering and path termination when using russian roulette. It also contains information
  * on the amount of memory to be allocated when processing different operations. Most notable of these
- * is the bin exponent that controls the size of the batches.
+ * is the bin exponent that controls the size of the batches. Every setting other than the depth,
+ * threshold, bucket, shading and bin settings is optional and takes the default given on
+ * construction.
  */
 struct Settings
 {
+  /**
+   * @brief      Initialiser list for class, holds the default of every setting
+   */
+  Settings()
+    : min_depth(2)
+    , max_depth(100)
+    , threshold(0.01f)
+    , bucket_size(16)
+    , shading_size(4096)
+    , bin_exponent(25)
+    , adaptive_threshold(0.f)
+    , sample_budget(0)
+    , min_iterations(2)
+    , texture_cache(256.f)
+    , texture_files(100)
+    , texture_autotile(0)
+    , texture_convert(0)
+    , texture_directory("")
+    , prefetch_threads(2)
+    , texture_sort(0)
+    , ray_budget(0)
+    , primary_packets(1)
+    , roulette_efficiency(1.f)
+    , bvh_profile(BVH_STANDARD)
+    , scene_updates(0)
+    , geometry_cache(0.f)
+  {;}
+
+  /**
+   * @brief      Depth below which paths are never terminated by russian roulette
+   */
   size_t min_depth;
+
+  /**
+   * @brief      Depth at which every path is terminated
+   */
   size_t max_depth;
+
+  /**
+   * @brief      Throughput below which paths become candidates for russian roulette
+   */
   float threshold;
+
+  /**
+   * @brief      Width and height of image tiles in pixels
+   */
   size_t bucket_size;
+
+  /**
+   * @brief      Largest number of hit points shaded as one range
+   */
   size_t shading_size;
+
+  /**
+   * @brief      Power of two giving the number of rays held by each batch
+   */
   size_t bin_exponent;
+
+  /**
+   * @brief      Relative error a tile must exceed to be sampled again, disabled when zero
+   */
+  float adaptive_threshold;
+
+  /**
+   * @brief      Samples per pixel after which rendering stops, unbounded when zero
+   */
+  size_t sample_budget;
+
+  /**
+   * @brief      Iterations rendered before adaptive sampling is applied
+   */
+  size_t min_iterations;
+
+  /**
+   * @brief      Size of the texture cache in megabytes
+   */
+  float texture_cache;
+
+  /**
+   * @brief      Limit on files held open by the texture cache
+   */
+  size_t texture_files;
+
+  /**
+   * @brief      Tile size used for untiled textures, disabled when zero
+   */
+  size_t texture_autotile;
+
+  /**
+   * @brief      Converts untiled textures into tiled mip mapped files in the texture directory when
+   *             enabled, tiled at the autotile size or 64 pixels when that is zero
+   */
+  size_t texture_convert;
+
+  /**
+   * @brief      Directory of converted textures, beside the scene file when empty
+   */
+  std::string texture_directory;
+
+  /**
+   * @brief      Threads loading texture tiles ahead of shading, disabled when zero
+   */
+  size_t prefetch_threads;
+
+  /**
+   * @brief      Orders hit points within each geometry by texture tile rather than primitive
+   */
+  size_t texture_sort;
+
+  /**
+   * @brief      Bounds the rays waiting in the bins and so scratch usage, unbounded when zero
+   */
+  size_t ray_budget;
+
+  /**
+   * @brief      Traces camera rays in packets directly instead of through the bins
+   */
+  size_t primary_packets;
+
+  /**
+   * @brief      Scales the survival probability of russian roulette
+   */
+  float roulette_efficiency;
+
+  /**
+   * @brief      Selects how embree builds the acceleration structure
+   */
+  BvhProfile bvh_profile;
+
+  /**
+   * @brief      Allows objects and lights to be edited after construction
+   */
+  size_t scene_updates;
+
+  /**
+   * @brief      Budget in megabytes for paging meshes of a scene bundle, disabled when zero
+   */
+  float geometry_cache;
 };
 
 MSC_NAMESPACE_END
@@ -31,15 +185,78 @@ template<> struct convert<msc::Settings>
 {
   static bool decode(const Node& node, msc::Settings& rhs)
   {
-    if(!node.IsMap() || node.size() != 6)
+    if(!node.IsMap() || node.size() < 6)
       return false;
 
+    rhs = msc::Settings();
+
     rhs.min_depth = node["min depth"].as<int>();
     rhs.max_depth = node["max depth"].as<int>();
     rhs.threshold = node["threshold"].as<float>();
     rhs.bucket_size = node["bucket size"].as<int>();
     rhs.shading_size = node["shading size"].as<int>();
     rhs.bin_exponent = node["bin exponent"].as<int>();
+
+    if(node["adaptive threshold"])
+      rhs.adaptive_threshold = node["adaptive threshold"].as<float>();
+
+    if(node["sample budget"])
+      rhs.sample_budget = node["sample budget"].as<size_t>();
+
+    if(node["min iterations"])
+      rhs.min_iterations = node["min iterations"].as<int>();
+
+    if(node["texture cache"])
+      rhs.texture_cache = node["texture cache"].as<float>();
+
+    if(node["texture files"])
+      rhs.texture_files = node["texture files"].as<int>();
+
+    if(node["texture autotile"])
+      rhs.texture_autotile = node["texture autotile"].as<int>();
+
+    if(node["texture convert"])
+      rhs.texture_convert = node["texture convert"].as<int>();
+
+    if(node["texture directory"])
+      rhs.texture_directory = node["texture directory"].as<std::string>();
+
+    if(node["prefetch threads"])
+      rhs.prefetch_threads = node["prefetch threads"].as<int>();
+
+    if(node["texture sort"])
+      rhs.texture_sort = node["texture sort"].as<int>();
+
+    if(node["ray budget"])
+      rhs.ray_budget = node["ray budget"].as<size_t>();
+
+    if(node["primary packets"])
+      rhs.primary_packets = node["primary packets"].as<int>();
+
+    if(node["roulette efficiency"])
+      rhs.roulette_efficiency = node["roulette efficiency"].as<float>();
+
+    if(node["bvh profile"])
+    {
+      std::string profile = node["bvh profile"].as< std::string >();
+      if(profile == "Fast")
+        rhs.bvh_profile = msc::BVH_FAST;
+      else if(profile == "Quality")
+        rhs.bvh_profile = msc::BVH_QUALITY;
+      else if(profile == "Compact")
+        rhs.bvh_profile = msc::BVH_COMPACT;
+      else if(profile == "Robust")
+        rhs.bvh_profile = msc::BVH_ROBUST;
+      else if(profile != "Standard")
+        throw RepresentationException(node["bvh profile"].Mark(), "unknown bvh profile " + profile);
+    }
+
+    if(node["scene updates"])
+      rhs.scene_updates = node["scene updates"].as<int>();
+
+    if(node["geometry cache"])
+      rhs.geometry_cache = node["geometry cache"].as<float>();
+
     return true;
   }
 };
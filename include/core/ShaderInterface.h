@@ -6,6 +6,7 @@
 #include <core/Common.h>
 #include <core/RandomGenerator.h>
 #include <core/OpenImageWrapper.h>
+#include <core/TextureConverter.h>
 
 MSC_NAMESPACE_BEGIN
 
@@ -35,14 +36,56 @@ public:
 
   /**
    * @brief      Initialize colour values potentially as vectorized texture lookup
+   *
+   * @param[in]  _size            number of positions
+   * @param      _u               u texture coordinates
+   * @param      _v               v texture coordinates
+   * @param      _footprint       filter width in texture space from the ray cone
+   * @param[in]  _texture_system  texture system used for lookups
+   * @param[in]  _thread_info     per thread texture system information
    */
   virtual void initialize(
     const size_t _size,
     std::vector< float >& _u,
     std::vector< float >& _v,
-    TextureSystem _texture_system
+    std::vector< float >& _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info
     ) =0;
 
+  /**
+   * @brief      Fault the texture tiles under a set of points into the cache without filtering
+   *
+   * @param[in]  _size            number of points
+   * @param[in]  _u               u texture coordinates
+   * @param[in]  _v               v texture coordinates
+   * @param[in]  _footprint       filter width in texture space
+   * @param[in]  _texture_system  texture system used for lookups
+   * @param[in]  _thread_info     per thread texture system information
+   */
+  virtual void prefetch(
+    const size_t _size,
+    const float* _u,
+    const float* _v,
+    const float* _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info
+    ) const =0;
+
+  /**
+   * @brief      Register texture files for conversion into tiled and mip mapped files
+   *
+   * @param      _converter  converter run at scene load
+   */
+  virtual void preconvert(TextureConverter* _converter) =0;
+
+  /**
+   * @brief      Resolve texture handles once at scene load to avoid looking up files by name
+   *
+   * @param[in]  _texture_system  texture system used for lookups
+   */
+  virtual void resolve(TextureSystem _texture_system) =0;
+
   /**
    * @brief      Get probabilty of bsdf reflectance for russian roulette
    *
@@ -0,0 +1,57 @@
+#ifndef _SHADINGKEY_H_
+#define _SHADINGKEY_H_
+
+#include <tbb/tbb.h>
+
+#include <core/Common.h>
+#include <core/Scene.h>
+#include <core/RayUncompressed.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Key of the texture cache tile holding a texture coordinate at the level of its footprint
+ *
+ * @param[in]  _u          u texture coordinate
+ * @param[in]  _v          v texture coordinate
+ * @param[in]  _footprint  filter width in texture space
+ *
+ * @return     mip level in the upper bits above the morton ordered tile coordinates
+ */
+unsigned int textureTile(const float _u, const float _v, const float _footprint);
+
+/**
+ * @brief      Functor class to compute texture coherent shading keys for hit points
+ * 
+ * Hit points on one large mesh that share a texture tile can end up far apart when sorted by
+ * primitive alone, while one range of geometry may span many distant regions of texture space.
+ * This computes a key from the mip level implied by the ray cone footprint and the coarse tile of
+ * texture space at that level, with the tile coordinates interleaved along a morton curve. Sorting
+ * by geometry and then this key keeps the lookups of each shading range within few cache tiles.
+ */
+class ShadingKey
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  ShadingKey(Scene* _scene, RayUncompressed* _batch)
+   : m_scene(_scene)
+   , m_batch(_batch)
+  {;}
+
+  /**
+   * @brief      Operator overloader to allow the class to act as a functor with tbb
+   * 
+   * @param[in]  r           a one dimensional range over an array of hit points
+   */
+  void operator()(const tbb::blocked_range< size_t >& r) const;
+
+private:
+  Scene* m_scene;
+  RayUncompressed* m_batch;
+};
+
+MSC_NAMESPACE_END
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef _SOBOLSAMPLER_H_
+#define _SOBOLSAMPLER_H_
+
+#include <core/Common.h>
+#include <core/SamplerInterface.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Inherits from the sampler interface and represents an Owen scrambled Sobol sampler
+ * 
+ * This will produce samples across the pixel area from the first two dimensions of the Sobol
+ * sequence with a nested uniform scramble seeded by the pixel generator. Every power of two prefix
+ * of the samples is stratified in both axes as well as across elementary intervals, while the
+ * scramble removes the structure between neighbouring pixels and iterations.
+ */
+class SobolSampler : public SamplerInterface
+{
+public:
+  /**
+   * @brief      Create scrambled low discrepancy samples across pixel area
+   *
+   * @param[in]  _base    base of sample count
+   * @param      _random  thread local random generator to prevent mutation
+   * @param      _output  output array of samples
+   */
+  void sample(const int _base, RandomGenerator* _random, float* _output) const;
+};
+
+MSC_NAMESPACE_END
+
+YAML_NAMESPACE_BEGIN
+
+template<> struct convert<msc::SobolSampler>
+{
+  static bool decode(const Node& node, msc::SobolSampler& rhs)
+  {
+    if(!node.IsMap() || node.size() != 1)
+      return false;
+    
+    return true;
+  }
+};
+
+YAML_NAMESPACE_END
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef _SPLAT_H_
+#define _SPLAT_H_
+
+#include <tbb/tbb.h>
+
+#include <core/Common.h>
+#include <core/Image.h>
+#include <core/Contribution.h>
+#include <core/FilterTable.h>
+#include <core/SamplerInterface.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Splats sorted contributions into filter weighted pixel accumulators
+ *
+ * This is a tbb functor class used by the splat film. The sorted contributions are divided into
+ * stripes of pixel rows that are taller than the filter footprint, and only every other stripe
+ * is processed at a time. This means that no two threads will write into the same pixel while the
+ * sample positions only need to be regenerated once for each run of contributions from a pixel.
+ */
+class Splat
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  Splat(
+    FilterTable* _filter,
+    SamplerInterface* _sampler,
+    Image* _image,
+    size_t _size,
+    Contribution* _data,
+    size_t _stripe,
+    size_t _phase
+    )
+   : m_filter(_filter)
+   , m_sampler(_sampler)
+   , m_image(_image)
+   , m_size(_size)
+   , m_data(_data)
+   , m_stripe(_stripe)
+   , m_phase(_phase)
+  {;}
+
+  /**
+   * @brief      Operator overloader to allow the class to act as a functor with tbb
+   *
+   * @param[in]  r           a one dimensional range over pairs of stripes
+   */
+  void operator()(const tbb::blocked_range< size_t >& r) const;
+
+private:
+  FilterTable* m_filter;
+  SamplerInterface* m_sampler;
+  Image* m_image;
+  size_t m_size;
+  Contribution* m_data;
+  size_t m_stripe;
+  size_t m_phase;
+};
+
+MSC_NAMESPACE_END
+
+#endif
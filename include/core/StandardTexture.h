@@ -10,13 +10,21 @@ MSC_NAMESPACE_BEGIN
 /**
  * @brief      Inherits from the shader interface and represents a non-cntributing surface
  * 
- * When initialized this will create a std::vector containing texture data for each position in a
- * range. Texture lookup is vectorized and sorted according to object and geometric primative. This
- * allows for optimal usage of memory when reading in large textures sets. 
+ * Texture lookups are emitted into the texture program and performed for every position in a range
+ * at once. Texture lookup is vectorized and sorted according to object and geometric primative. This
+ * allows for optimal usage of memory when reading in large textures sets. The texture handle is
+ * resolved once at scene load so that lookups avoid searching for the file by name.
  */
 class StandardTexture : public TextureInterface
 {
 public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  StandardTexture()
+    : m_handle(NULL)
+  {;}
+
   /**
    * @brief      Getter method for texture path
    *
@@ -39,27 +47,74 @@ public:
   TextureInterface* clone();
 
   /**
-   * @brief      Initialize colour values potentially as vectorized texture lookup
+   * @brief      Register texture files for conversion into tiled and mip mapped files
+   *
+   * @param      _converter  converter run at scene load
    */
-  void initialize(
+  void preconvert(TextureConverter* _converter);
+
+  /**
+   * @brief      Resolve texture handles once at scene load to avoid looking up files by name
+   *
+   * @param[in]  _texture_system  texture system used for lookups
+   */
+  void resolve(TextureSystem _texture_system);
+  
+  /**
+   * @brief      Emit this node into a texture program
+   *
+   * @param      _program   program being compiled
+   * @param[in]  _runflags  runflags for points where this node is visible
+   *
+   * @return     folded constant or register holding the result
+   */
+  TextureOperand compile(TextureProgram* _program, const size_t _runflags) const;
+
+  /**
+   * @brief      Batched texture lookup used by the texture program
+   *
+   * @param[in]  _size            number of points
+   * @param      _runflags        points to look up
+   * @param      _u               u texture coordinates
+   * @param      _v               v texture coordinates
+   * @param      _footprint       filter width in texture space
+   * @param[in]  _texture_system  texture system used for lookups
+   * @param[in]  _thread_info     per thread texture system information
+   * @param      _output          interleaved rgb output
+   */
+  void lookup(
     const size_t _size,
+    OpenImageIO::Runflag* _runflags,
     std::vector< float >& _u,
     std::vector< float >& _v,
-    TextureSystem _texture_system
-    );
-  
+    std::vector< float >& _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info,
+    float* _output
+    ) const;
+
   /**
-   * @brief      Gets colour value according to index
+   * @brief      Fault the texture tiles under a set of points into the cache with a single unfiltered texel for each
    *
-   * @param[in]  _index  colour index to find value for specific position
-   *
-   * @return     colour according to index
+   * @param[in]  _size            number of points
+   * @param[in]  _u               u texture coordinates
+   * @param[in]  _v               v texture coordinates
+   * @param[in]  _footprint       filter width in texture space
+   * @param[in]  _texture_system  texture system used for lookups
+   * @param[in]  _thread_info     per thread texture system information
    */
-  Colour3f colour(const size_t _index) const;
+  void prefetch(
+    const size_t _size,
+    const float* _u,
+    const float* _v,
+    const float* _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info
+    ) const;
 
 private:
   OpenImageIO::ustring m_string;
-  std::vector< Colour3f > m_colour;
+  TextureHandle m_handle;
 };
 
 MSC_NAMESPACE_END
@@ -0,0 +1,55 @@
+#ifndef _TEXTURECONVERTER_H_
+#define _TEXTURECONVERTER_H_
+
+#include <string>
+#include <vector>
+
+#include <core/Common.h>
+
+MSC_NAMESPACE_BEGIN
+
+class StandardTexture;
+
+/**
+ * @brief      Converts untiled textures into a cache of tiled and mip mapped files at scene load
+ * 
+ * Texture cache lookups are only proportional to the filter footprint when files are tiled and
+ * mip mapped, otherwise the whole image is decoded on first access. Standard textures are collected
+ * from the shaders and every unique file that is missing tiles or mip levels is converted in
+ * parallel into the cache directory. Converted files are named by a hash of the source contents
+ * and the conversion parameters, so identical files share a conversion. Every source also leaves a
+ * small reference keyed on its path, size, modification time and the parameters, so later renders
+ * find the conversion without reading the source and edited sources are converted again.
+ */
+class TextureConverter
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  TextureConverter(const std::string& _directory, const int _tile_size)
+   : m_directory(_directory)
+   , m_tile_size(_tile_size)
+  {;}
+
+  /**
+   * @brief      Register texture to be converted
+   *
+   * @param      _texture  standard texture whose path is replaced once converted
+   */
+  void insert(StandardTexture* _texture);
+
+  /**
+   * @brief      Convert registered textures and point them at the cached files
+   */
+  void convert();
+
+private:
+  std::string m_directory;
+  int m_tile_size;
+  std::vector< StandardTexture* > m_textures;
+};
+
+MSC_NAMESPACE_END
+
+#endif
@@ -5,16 +5,18 @@
 
 #include <core/Common.h>
 #include <core/OpenImageWrapper.h>
+#include <core/TextureConverter.h>
+#include <core/TextureProgram.h>
 
 MSC_NAMESPACE_BEGIN
 
 /**
  * @brief      Abstract interface class for surface shaders
  * 
- * This is an interface for using a texture in a polymorphic sense. It describes three main methods
- * that are responsible for cloning the class to allow for mutation on each thread locally,
- * initializing the texture to cache the texture colour and finally retrieving the value according
- * to an index.
+ * This is an interface for using a texture in a polymorphic sense. Textures form the nodes of a
+ * graph that is compiled into a flat texture program at scene load, so the interface describes
+ * methods for cloning the class, resolving any texture handles and emitting the node into the
+ * program. The program is then responsible for evaluating the colour across shading ranges.
  */
 class TextureInterface
 {
@@ -32,18 +34,30 @@ public:
   virtual TextureInterface* clone() = 0;
 
   /**
-   * @brief      Initialize colour values potentially as vectorized texture lookup
+   * @brief      Register texture files for conversion into tiled and mip mapped files
+   *
+   * @param      _converter  converter run at scene load
+   */
+  virtual void preconvert(TextureConverter* _converter) =0;
+
+  /**
+   * @brief      Resolve texture handles once at scene load to avoid looking up files by name
+   *
+   * @param[in]  _texture_system  texture system used for lookups
+   */
+  virtual void resolve(TextureSystem _texture_system) =0;
+
+  /**
+   * @brief      Emit this node into a texture program
+   *
+   * @param      _program   program being compiled
+   * @param[in]  _runflags  runflags for points where this node is visible
+   *
+   * @return     folded constant or register holding the result
    */
-  virtual void initialize(
-    const size_t _size,
-    std::vector< float >& _u,
-    std::vector< float >& _v,
-    TextureSystem _texture_system
-    ) =0;
-
-  virtual Colour3f colour(const size_t _index) const =0;
+  virtual TextureOperand compile(TextureProgram* _program, const size_t _runflags) const =0;
 };
 
 MSC_NAMESPACE_END
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,184 @@
+#ifndef _TEXTUREPROGRAM_H_
+#define _TEXTUREPROGRAM_H_
+
+#include <vector>
+
+#include <core/Common.h>
+#include <core/OpenImageWrapper.h>
+
+MSC_NAMESPACE_BEGIN
+
+class TextureInterface;
+class StandardTexture;
+
+/**
+ * @brief      Result of compiling a texture node
+ * 
+ * A node either folds into a constant colour or writes into a register of the program.
+ */
+struct TextureOperand
+{
+  bool constant;
+  Colour3f colour;
+  size_t index;
+};
+
+/**
+ * @brief      Operation codes used by the texture program
+ */
+enum TextureOperation
+{
+  TEXTURE_CONSTANT,
+  TEXTURE_LOOKUP,
+  TEXTURE_RUNFLAGS,
+  TEXTURE_BLEND
+};
+
+/**
+ * @brief      Single instruction of the texture program
+ */
+struct TextureInstruction
+{
+  TextureOperation operation;
+  size_t output;
+  size_t input[3];
+  size_t runflags;
+  bool inverse;
+  Colour3f colour;
+  const StandardTexture* texture;
+};
+
+/**
+ * @brief      Flat program compiled from a texture tree
+ * 
+ * The texture tree is compiled once at scene load into a list of instructions over registers that
+ * each hold a colour for every point of a shading range as a structure of arrays. Constant nodes
+ * are folded and layers with constant masks are pruned. Varying masks produce runflags so that a
+ * texture lookup only runs for points where its layer is visible, and is skipped entirely when no
+ * point is. The remaining blends run as single passes over contiguous arrays that vectorise.
+ */
+class TextureProgram
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  TextureProgram()
+   : m_register_count(0)
+   , m_runflag_count(1)
+  {;}
+
+  /**
+   * @brief      Compile texture tree into program
+   *
+   * @param[in]  _texture  root of texture tree
+   */
+  void compile(const TextureInterface* _texture);
+
+  /**
+   * @brief      Check if the whole tree folded into a constant
+   *
+   * @return     constant state
+   */
+  inline bool constant() const {return m_result.constant;}
+
+  /**
+   * @brief      Getter method for the folded colour
+   *
+   * @return     constant colour
+   */
+  inline Colour3f colour() const {return m_result.colour;}
+
+  /**
+   * @brief      Emit constant node
+   *
+   * @param[in]  _colour  constant colour
+   *
+   * @return     folded operand
+   */
+  TextureOperand constant(const Colour3f& _colour);
+
+  /**
+   * @brief      Emit texture lookup
+   *
+   * @param[in]  _texture   texture to look up
+   * @param[in]  _runflags  runflags guarding the lookup
+   *
+   * @return     register operand
+   */
+  TextureOperand lookup(const StandardTexture* _texture, const size_t _runflags);
+
+  /**
+   * @brief      Emit runflags for points where a mask is non zero, or not one when inverted
+   *
+   * @param[in]  _mask      mask operand
+   * @param[in]  _runflags  parent runflags
+   * @param[in]  _inverse   whether to test the inverse of the mask
+   *
+   * @return     runflags index
+   */
+  size_t runflags(const TextureOperand& _mask, const size_t _runflags, const bool _inverse);
+
+  /**
+   * @brief      Emit blend of two operands by a mask, folding when possible
+   *
+   * @param[in]  _upper  upper operand
+   * @param[in]  _lower  lower operand
+   * @param[in]  _mask   mask operand
+   *
+   * @return     resulting operand
+   */
+  TextureOperand blend(const TextureOperand& _upper, const TextureOperand& _lower, const TextureOperand& _mask);
+
+  /**
+   * @brief      Execute program over a range of shading points
+   *
+   * @param[in]  _size            number of points
+   * @param      _u               u texture coordinates
+   * @param      _v               v texture coordinates
+   * @param      _footprint       filter width in texture space
+   * @param[in]  _texture_system  texture system used for lookups
+   * @param[in]  _thread_info     per thread texture system information
+   * @param      _output          colour of each point as a structure of arrays
+   */
+  void execute(
+    const size_t _size,
+    std::vector< float >& _u,
+    std::vector< float >& _v,
+    std::vector< float >& _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info,
+    std::vector< float >* _output
+    ) const;
+
+  /**
+   * @brief      Fault the tiles of every texture the program looks up under a set of points
+   *
+   * @param[in]  _size            number of points
+   * @param[in]  _u               u texture coordinates
+   * @param[in]  _v               v texture coordinates
+   * @param[in]  _footprint       filter width in texture space
+   * @param[in]  _texture_system  texture system used for lookups
+   * @param[in]  _thread_info     per thread texture system information
+   */
+  void prefetch(
+    const size_t _size,
+    const float* _u,
+    const float* _v,
+    const float* _footprint,
+    TextureSystem _texture_system,
+    TexturePerthread _thread_info
+    ) const;
+
+private:
+  std::vector< TextureInstruction > m_instructions;
+  size_t m_register_count;
+  size_t m_runflag_count;
+  TextureOperand m_result;
+
+  size_t materialize(const TextureOperand& _operand);
+};
+
+MSC_NAMESPACE_END
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef _TONEMAP_H_
+#define _TONEMAP_H_
+
+#include <tbb/blocked_range.h>
+
+#include <core/Common.h>
+#include <core/Image.h>
+
+MSC_NAMESPACE_BEGIN
+
+/**
+ * @brief      Converts the resolved pixels of dirty tiles into an eight bit preview
+ * 
+ * This is a tbb functor class that clamps the running mean of each pixel and quantises it into
+ * an eight bit buffer matching the image resolution. Each tile row is converted as a single
+ * contiguous run of floats so that the conversion vectorises.
+ */
+class Tonemap
+{
+public:
+  /**
+   * @brief      Initialiser list for class
+   */
+  Tonemap(Image* _image, const size_t* _tiles, unsigned char* _output)
+   : m_image(_image)
+   , m_tiles(_tiles)
+   , m_output(_output)
+  {;}
+
+  /**
+   * @brief      Operator overloader to allow the class to act as a functor with tbb
+   * 
+   * @param[in]  r           a one dimentional blocked range over dirty tile indices
+   */
+  void operator()(const tbb::blocked_range< size_t > &r) const;
+
+private:
+  Image* m_image;
+  const size_t* m_tiles;
+  unsigned char* m_output;
+};
+
+MSC_NAMESPACE_END
+
+#endif
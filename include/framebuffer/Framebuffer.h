@@ -84,6 +84,19 @@ public:
    */
   void image(const unsigned char* _image, const int _resx, const int _resy);
 
+  /**
+   * @brief      Upload a rectangular region of the image data onto the gpu
+   *
+   * @param[in]  _image     pointer to image data of full resolution
+   * @param[in]  _resx      horizontal resolution
+   * @param[in]  _resy      vertical resolution
+   * @param[in]  _x         horizontal offset of region
+   * @param[in]  _y         vertical offset of region
+   * @param[in]  _width     width of region
+   * @param[in]  _height    height of region
+   */
+  void image(const unsigned char* _image, const int _resx, const int _resy, const int _x, const int _y, const int _width, const int _height);
+
   /**
    * @brief      Set framebuffer window title to string
    *
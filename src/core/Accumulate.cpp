@@ -0,0 +1,27 @@
+#include <core/Accumulate.h>
+
+MSC_NAMESPACE_BEGIN
+
+void Accumulate::operator()(const tbb::blocked_range< size_t >& r) const
+{
+  size_t begin = r.begin();
+  size_t end = r.end();
+
+  // Runs that started in the previous range belong to it
+  while(begin < end && begin > 0 && m_data[begin].sampleID == m_data[begin - 1].sampleID)
+    ++begin;
+
+  // Runs that start in this range are finished here
+  while(end < m_size && end > 0 && m_data[end].sampleID == m_data[end - 1].sampleID)
+    ++end;
+
+  for(size_t index = begin; index < end; ++index)
+  {
+    Sample& sample = m_image->samples[m_data[index].sampleID];
+    sample.r += m_data[index].r;
+    sample.g += m_data[index].g;
+    sample.b += m_data[index].b;
+  }
+}
+
+MSC_NAMESPACE_END
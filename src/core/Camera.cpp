@@ -1,49 +1,89 @@
 #include <core/Camera.h>
 #include <core/RayCompressed.h>
+#include <core/RayDecompress.h>
 
 MSC_NAMESPACE_BEGIN
 
-void Camera::operator()(const tbb::blocked_range2d< size_t > &r) const
+void Camera::operator()(const tbb::blocked_range< size_t > &r) const
 {
-  LocalRandomGenerator::reference random = m_local_thread_storage->local();
+  RandomGenerator pixel_random;
 
   size_t count = m_image->base * m_image->base;
 
+  // Angle subtended by a pixel on the film plane from the nodal point
+  float spread = (72.f / m_image->width) / m_camera->focalLength();
+
   float* samples = new float[count * 2];
+  float* lens = new float[count * 2];
   RayCompressed* rays = new RayCompressed[count];
 
-  for(size_t index_x = r.rows().begin(); index_x < r.rows().end(); ++index_x)
+  for(size_t index_tile = r.begin(); index_tile < r.end(); ++index_tile)
   {
-    for(size_t index_y = r.cols().begin(); index_y < r.cols().end(); ++index_y)
-    {
-      m_sampler->sample(m_image->base, &random, samples);
+    const Tile& tile = m_image->tiles[index_tile];
 
-      for(size_t index = 0; index < count; ++index)
-      {
-        rays[index].weight[0] = 1.f;
-        rays[index].weight[1] = 1.f;
-        rays[index].weight[2] = 1.f;
-        rays[index].lastPdf = 1.f;
-        rays[index].rayDepth = 0;
-        rays[index].sampleID = (index_x * m_image->height * count) + (index_y * count) + index;
-        m_image->samples[rays[index].sampleID].r = 0.f;
-        m_image->samples[rays[index].sampleID].g = 0.f;
-        m_image->samples[rays[index].sampleID].b = 0.f;
-        m_image->samples[rays[index].sampleID].x = index_x + samples[2 * index + 0];
-        m_image->samples[rays[index].sampleID].y = index_y + samples[2 * index + 1];
-        samples[2 * index + 0] = (((index_x + samples[2 * index + 0]) * 2.f - m_image->width) / m_image->width) * 36.f;
-        samples[2 * index + 1] = (((index_y + samples[2 * index + 1]) * 2.f - m_image->height) / m_image->width) * 36.f;
-      }
+    if(!tile.sampled)
+      continue;
 
-      m_camera->sample(count, samples, &random, rays);
+    size_t position = (m_output != NULL) ? m_offsets[index_tile] : 0;
 
-      for(size_t index = 0; index < count; ++index)
+    for(size_t index_y = tile.y; index_y < tile.y + tile.height; ++index_y)
+    {
+      for(size_t index_x = tile.x; index_x < tile.x + tile.width; ++index_x)
       {
-        int max = (fabs(rays[index].dir[0]) < fabs(rays[index].dir[1])) ? 1 : 0;
-        int axis = (fabs(rays[index].dir[max]) < fabs(rays[index].dir[2])) ? 2 : max;
-        int cardinal = (rays[index].dir[axis] < 0.f) ? axis : axis + 3;
+        pixel_random.seed(pixelSeed(index_y * m_image->width + index_x, m_image->iteration));
+        m_sampler->sample(m_image->base, &pixel_random, samples);
+
+        for(size_t index = 0; index < count; ++index)
+        {
+          rays[index].weight[0] = 1.f;
+          rays[index].weight[1] = 1.f;
+          rays[index].weight[2] = 1.f;
+          rays[index].lastPdf = 1.f;
+          rays[index].coneWidth = 0.f;
+          rays[index].coneSpread = spread;
+          rays[index].rayDepth = 0;
+          rays[index].sampleID = ((index_y * m_image->width + index_x) * count) + index;
+          samples[2 * index + 0] = (((index_x + samples[2 * index + 0]) * 2.f - m_image->width) / m_image->width) * 36.f;
+          samples[2 * index + 1] = (((index_y + samples[2 * index + 1]) * 2.f - m_image->height) / m_image->width) * 36.f;
+        }
 
-        m_buffer.direction[cardinal].push_back(rays[index]);
+        if(m_image->film == FILM_SAMPLE)
+        {
+          size_t sample_begin = (index_y * m_image->width + index_x) * count;
+          for(size_t index = 0; index < count; ++index)
+          {
+            m_image->samples[sample_begin + index].r = 0.f;
+            m_image->samples[sample_begin + index].g = 0.f;
+            m_image->samples[sample_begin + index].b = 0.f;
+          }
+        }
+
+        // Lens samples take their own dimensions of the first path vertex's sequence
+        sequenceSamples(
+          mixBits(pathKey(index_y * m_image->width + index_x, 0)),
+          m_image->iteration * count,
+          DIMENSION_LENS,
+          count,
+          lens
+          );
+
+        m_camera->sample(count, samples, lens, rays);
+
+        if(m_output != NULL)
+        {
+          for(size_t index = 0; index < count; ++index)
+            decompress(rays[index], &(m_output[position++]));
+          continue;
+        }
+
+        for(size_t index = 0; index < count; ++index)
+        {
+          int max = (fabs(rays[index].dir[0]) < fabs(rays[index].dir[1])) ? 1 : 0;
+          int axis = (fabs(rays[index].dir[max]) < fabs(rays[index].dir[2])) ? 2 : max;
+          int cardinal = (rays[index].dir[axis] < 0.f) ? axis : axis + 3;
+
+          m_buffer.direction[cardinal].push_back(rays[index]);
+        }
       }
     }
   }
@@ -52,9 +92,12 @@ void Camera::operator()(const tbb::blocked_range2d< size_t > &r) const
   {
     if(m_buffer.direction[index].size() > 0)
       m_bins->add(m_buffer.direction[index].size(), index, &(m_buffer.direction[index][0]), m_batch_queue);
+
+    m_buffer.direction[index].clear();
   }
 
   delete[] samples;
+  delete[] lens;
   delete[] rays;
 }
 
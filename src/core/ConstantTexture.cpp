@@ -9,19 +9,19 @@ TextureInterface* ConstantTexture::clone()
   return new ConstantTexture(*this);
 }
 
-void ConstantTexture::initialize(
-  const size_t _size,
-  std::vector< float >& _u,
-  std::vector< float >& _v,
-  TextureSystem _texture_system
-  )
+void ConstantTexture::preconvert(TextureConverter* _converter)
 {
-  // Nothing to initialize
+  // Nothing to convert
 }
 
-Colour3f ConstantTexture::colour(const size_t _index) const
+void ConstantTexture::resolve(TextureSystem _texture_system)
 {
-  return m_constant;
+  // Nothing to resolve
 }
 
-MSC_NAMESPACE_END
\ No newline at end of file
+TextureOperand ConstantTexture::compile(TextureProgram* _program, const size_t _runflags) const
+{
+  return _program->constant(m_constant);
+}
+
+MSC_NAMESPACE_END
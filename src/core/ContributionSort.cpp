@@ -0,0 +1,119 @@
+#include <vector>
+
+#include <tbb/tbb.h>
+
+#include <core/ContributionSort.h>
+
+MSC_NAMESPACE_BEGIN
+
+namespace
+{
+  const size_t radix = 256;
+  const size_t block_size = 65536;
+
+  // Counts the digits of each block independently
+  struct DigitCount
+  {
+    size_t size;
+    size_t shift;
+    const Contribution* input;
+    size_t* histogram;
+
+    void operator()(const size_t _block) const
+    {
+      size_t* count = &(histogram[_block * radix]);
+      size_t end = std::min(size, (_block + 1) * block_size);
+
+      for(size_t index = _block * block_size; index < end; ++index)
+        count[(input[index].sampleID >> shift) & 0xFF] += 1;
+    }
+  };
+
+  // Scatters each block to its offsets within the output
+  struct DigitScatter
+  {
+    size_t size;
+    size_t shift;
+    const Contribution* input;
+    Contribution* output;
+    size_t* histogram;
+
+    void operator()(const size_t _block) const
+    {
+      size_t* position = &(histogram[_block * radix]);
+      size_t end = std::min(size, (_block + 1) * block_size);
+
+      for(size_t index = _block * block_size; index < end; ++index)
+        output[position[(input[index].sampleID >> shift) & 0xFF]++] = input[index];
+    }
+  };
+}
+
+void ContributionSort::operator()() const
+{
+  if(m_size < 2)
+    return;
+
+  size_t block_count = (m_size + block_size - 1) / block_size;
+  std::vector< size_t > histogram(block_count * radix);
+
+  Contribution* input = m_data;
+  Contribution* output = m_temp;
+
+  for(size_t shift = 0; shift < 32; shift += 8)
+  {
+    std::fill(histogram.begin(), histogram.end(), 0);
+
+    DigitCount count;
+    count.size = m_size;
+    count.shift = shift;
+    count.input = input;
+    count.histogram = &(histogram[0]);
+    tbb::parallel_for(size_t(0), block_count, count);
+
+    // Skip pass if every key shares the same digit
+    bool constant = false;
+    for(size_t digit = 0; digit < radix; ++digit)
+    {
+      size_t total = 0;
+      for(size_t block = 0; block < block_count; ++block)
+        total += histogram[block * radix + digit];
+
+      if(total > 0)
+      {
+        constant = (total == m_size);
+        break;
+      }
+    }
+
+    if(constant)
+      continue;
+
+    // Exclusive prefix sum ordered by digit then block to keep the sort stable
+    size_t offset = 0;
+    for(size_t digit = 0; digit < radix; ++digit)
+    {
+      for(size_t block = 0; block < block_count; ++block)
+      {
+        size_t total = histogram[block * radix + digit];
+        histogram[block * radix + digit] = offset;
+        offset += total;
+      }
+    }
+
+    DigitScatter scatter;
+    scatter.size = m_size;
+    scatter.shift = shift;
+    scatter.input = input;
+    scatter.output = output;
+    scatter.histogram = &(histogram[0]);
+    tbb::parallel_for(size_t(0), block_count, scatter);
+
+    std::swap(input, output);
+  }
+
+  if(input != m_data)
+    std::copy(input, input + m_size, m_data);
+}
+
+MSC_NAMESPACE_END
@@ -1,20 +1,178 @@
+#include <vector>
+#include <limits>
+
 #include <core/Convolve.h>
 
 MSC_NAMESPACE_BEGIN
 
-void Convolve::operator()(const tbb::blocked_range2d< size_t > &r) const
+void Convolve::operator()(const tbb::blocked_range< size_t > &r) const
+{
+  for(size_t index_tile = r.begin(); index_tile < r.end(); ++index_tile)
+  {
+    if(m_image->tiles[index_tile].sampled)
+      resolve(&(m_image->tiles[index_tile]));
+  }
+}
+
+void Convolve::resolve(Tile* _tile) const
 {
-  m_filter->convolve(
-    m_image->width,
-    m_image->height,
-    m_image->base * m_image->base,
-    r.rows().begin(),
-    r.rows().end(),
-    r.cols().begin(),
-    r.cols().end(),
-    &(m_image->samples[0]),
-    &(m_image->pixels[0])
-    );
+  int width = m_image->width;
+  int height = m_image->height;
+  int margin = m_filter->margin();
+  int span = 2 * margin + 1;
+  size_t count = m_image->base * m_image->base;
+  bool splat = (m_image->film == FILM_SPLAT);
+
+  int rows_begin = _tile->x;
+  int rows_end = _tile->x + _tile->width;
+  int cols_begin = _tile->y;
+  int cols_end = _tile->y + _tile->height;
+  int tile_width = rows_end - rows_begin;
+  int tile_size = tile_width * (cols_end - cols_begin);
+
+  // Tile local accumulators stored row major
+  std::vector< float > summation_r(tile_size, 0.f);
+  std::vector< float > summation_g(tile_size, 0.f);
+  std::vector< float > summation_b(tile_size, 0.f);
+  std::vector< float > denominator(tile_size, 0.f);
+
+  // Per pixel sample data stored as structure of arrays
+  std::vector< float > positions(count * 2);
+  std::vector< float > position_x(count);
+  std::vector< float > position_y(count);
+  std::vector< float > colour_r(count, 0.f);
+  std::vector< float > colour_g(count, 0.f);
+  std::vector< float > colour_b(count, 0.f);
+  std::vector< float > weight_x(span * count);
+  std::vector< float > weight_y(span * count);
+
+  RandomGenerator pixel_random;
+
+  for(int pixel_y = std::max(0, cols_begin - margin); pixel_y < std::min(height, cols_end + margin); ++pixel_y)
+  {
+    for(int pixel_x = std::max(0, rows_begin - margin); pixel_x < std::min(width, rows_end + margin); ++pixel_x)
+    {
+      // Pixels of neighbouring tiles that were not sampled hold stale data from earlier iterations
+      size_t pixel_tile = (pixel_y / m_image->tile_size) * m_image->tile_columns + (pixel_x / m_image->tile_size);
+      if(!m_image->tiles[pixel_tile].sampled)
+        continue;
+
+      pixel_random.seed(pixelSeed(pixel_y * width + pixel_x, m_image->iteration));
+      m_sampler->sample(m_image->base, &pixel_random, &(positions[0]));
+
+      for(size_t index_sample = 0; index_sample < count; ++index_sample)
+      {
+        position_x[index_sample] = pixel_x + positions[2 * index_sample + 0];
+        position_y[index_sample] = pixel_y + positions[2 * index_sample + 1];
+      }
+
+      if(!splat)
+      {
+        const Sample* samples = &(m_image->samples[(pixel_y * width + pixel_x) * count]);
+        for(size_t index_sample = 0; index_sample < count; ++index_sample)
+        {
+          colour_r[index_sample] = samples[index_sample].r;
+          colour_g[index_sample] = samples[index_sample].g;
+          colour_b[index_sample] = samples[index_sample].b;
+        }
+      }
+
+      int target_x_begin = std::max(rows_begin, pixel_x - margin);
+      int target_x_end = std::min(rows_end, pixel_x + margin + 1);
+      int target_y_begin = std::max(cols_begin, pixel_y - margin);
+      int target_y_end = std::min(cols_end, pixel_y + margin + 1);
+
+      // Separable weights for each sample against each target row and column
+      for(int target_x = target_x_begin; target_x < target_x_end; ++target_x)
+        m_filter->evaluate(count, target_x + 0.5f, &(position_x[0]), &(weight_x[(target_x - target_x_begin) * count]));
+
+      for(int target_y = target_y_begin; target_y < target_y_end; ++target_y)
+        m_filter->evaluate(count, target_y + 0.5f, &(position_y[0]), &(weight_y[(target_y - target_y_begin) * count]));
+
+      for(int target_y = target_y_begin; target_y < target_y_end; ++target_y)
+      {
+        const float* row_weight = &(weight_y[(target_y - target_y_begin) * count]);
+
+        for(int target_x = target_x_begin; target_x < target_x_end; ++target_x)
+        {
+          const float* column_weight = &(weight_x[(target_x - target_x_begin) * count]);
+          size_t local_index = (target_y - cols_begin) * tile_width + (target_x - rows_begin);
+
+          float total_weight = 0.f;
+          float total_r = 0.f;
+          float total_g = 0.f;
+          float total_b = 0.f;
+
+          for(size_t index_sample = 0; index_sample < count; ++index_sample)
+          {
+            float multiplier = row_weight[index_sample] * column_weight[index_sample];
+            total_weight += multiplier;
+            total_r += colour_r[index_sample] * multiplier;
+            total_g += colour_g[index_sample] * multiplier;
+            total_b += colour_b[index_sample] * multiplier;
+          }
+
+          denominator[local_index] += total_weight;
+          summation_r[local_index] += total_r;
+          summation_g[local_index] += total_g;
+          summation_b[local_index] += total_b;
+        }
+      }
+    }
+  }
+
+  // Fold this iteration into the running mean and luminance variance of each pixel
+  float count_inverse = 1.f / (_tile->iteration + 1);
+  float error = 0.f;
+
+  for(int index_pixel_y = cols_begin; index_pixel_y < cols_end; ++index_pixel_y)
+  {
+    for(int index_pixel_x = rows_begin; index_pixel_x < rows_end; ++index_pixel_x)
+    {
+      size_t local_index = (index_pixel_y - cols_begin) * tile_width + (index_pixel_x - rows_begin);
+      size_t pixel_index = index_pixel_y * width + index_pixel_x;
+
+      Pixel estimate;
+      estimate.r = 0.f;
+      estimate.g = 0.f;
+      estimate.b = 0.f;
+
+      // Negative lobes can cancel out the weight entirely so guard against tiny denominators
+      if(fabsf(denominator[local_index]) > 1e-6f)
+      {
+        if(splat)
+        {
+          summation_r[local_index] = m_image->splats[pixel_index].r;
+          summation_g[local_index] = m_image->splats[pixel_index].g;
+          summation_b[local_index] = m_image->splats[pixel_index].b;
+        }
+
+        estimate.r = summation_r[local_index] / denominator[local_index];
+        estimate.g = summation_g[local_index] / denominator[local_index];
+        estimate.b = summation_b[local_index] / denominator[local_index];
+      }
+
+      Pixel& mean = m_image->pixels[pixel_index];
+      float delta = luminance(estimate) - luminance(mean);
+
+      mean.r += (estimate.r - mean.r) * count_inverse;
+      mean.g += (estimate.g - mean.g) * count_inverse;
+      mean.b += (estimate.b - mean.b) * count_inverse;
+
+      m_image->variance[pixel_index] += delta * (luminance(estimate) - luminance(mean));
+
+      // Relative standard error of the mean, offset to avoid dark pixels dominating
+      if(_tile->iteration > 0)
+      {
+        float mean_variance = m_image->variance[pixel_index] * count_inverse / _tile->iteration;
+        error += sqrtf(fmaxf(0.f, mean_variance)) / (luminance(mean) + 0.01f);
+      }
+    }
+  }
+
+  _tile->error = (_tile->iteration > 0) ? error / (_tile->width * _tile->height) : std::numeric_limits< float >::max();
+  _tile->iteration += 1;
+  _tile->dirty = true;
 }
 
-MSC_NAMESPACE_END
\ No newline at end of file
+MSC_NAMESPACE_END
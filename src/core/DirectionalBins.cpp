@@ -2,7 +2,7 @@
 
 MSC_NAMESPACE_BEGIN
 
-DirectionalBins::DirectionalBins(size_t _exponent) : m_exponent(_exponent)
+DirectionalBins::DirectionalBins(size_t _exponent) : m_exponent(_exponent), m_pending(0)
 {
   for(size_t index = 0; index < 6; ++index)
   {
@@ -68,6 +68,7 @@ void DirectionalBins::add(const int _size, const int _cardinal, RayCompressed* _
 
   m_bin[_cardinal].pointer = std::copy(_data, _data + _size, m_bin[_cardinal].pointer);
   m_bin[_cardinal].size = m_bin[_cardinal].size + _size;
+  m_pending += _size;
   
   m_bin[_cardinal].mutex.unlock();
 }
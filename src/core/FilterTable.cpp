@@ -0,0 +1,32 @@
+#include <core/FilterTable.h>
+
+MSC_NAMESPACE_BEGIN
+
+FilterTable::FilterTable(const FilterInterface* _filter, const size_t _resolution)
+ : m_radius(_filter->radius())
+ , m_margin(std::max(0, int(ceil(_filter->radius() - 0.5f))))
+ , m_scale(_resolution / _filter->radius())
+ , m_resolution(_resolution)
+ , m_table(_resolution + 2, 0.f)
+{
+  // Sample each entry at its center, the last two entries hold the edge of the filter and zero
+  for(size_t index = 0; index < m_resolution; ++index)
+    m_table[index] = _filter->evaluate((index + 0.5f) / m_scale);
+
+  m_table[m_resolution] = _filter->evaluate(m_radius);
+  m_table[m_resolution + 1] = 0.f;
+}
+
+void FilterTable::evaluate(const size_t _count, const float _center, const float* _position, float* _output) const
+{
+  const float* table = &(m_table[0]);
+
+  // Clamping rather than branching keeps the loop vectorisable with gathers
+  for(size_t index = 0; index < _count; ++index)
+  {
+    float distance = fminf(fabsf(_center - _position[index]) * m_scale, float(m_resolution + 1));
+    _output[index] = table[static_cast< int >(distance)];
+  }
+}
+
+MSC_NAMESPACE_END
@@ -0,0 +1,15 @@
+#include <core/GaussianFilter.h>
+
+MSC_NAMESPACE_BEGIN
+
+float GaussianFilter::radius() const
+{
+  return m_radius;
+}
+
+float GaussianFilter::evaluate(const float _distance) const
+{
+  return fmax(0.f, expf(-m_alpha * _distance * _distance) - expf(-m_alpha * m_radius * m_radius));
+}
+
+MSC_NAMESPACE_END
@@ -0,0 +1,398 @@
+#include <algorithm>
+
+#include <boost/thread/mutex.hpp>
+
+#include <core/GeometryCache.h>
+
+MSC_NAMESPACE_BEGIN
+
+namespace
+{
+  // Two triangles for each face of a box whose corners are numbered by their x, y and z bits
+  const unsigned int box_indices[36] = {
+    0, 2, 6, 0, 6, 4,
+    1, 5, 7, 1, 7, 3,
+    0, 4, 5, 0, 5, 1,
+    2, 3, 7, 2, 7, 6,
+    0, 1, 3, 0, 3, 2,
+    4, 6, 7, 4, 7, 5
+    };
+
+  // Embree hands filter functions the ray it was given, so candidates are carried alongside it
+  struct ProxyRay
+  {
+    RTCRay rtc_ray;
+    std::vector< std::pair< float, unsigned int > >* candidates;
+  };
+
+  // Records every proxy along the ray and rejects the hit so that traversal carries on
+  void proxyFilter(void* _ptr, RTCRay& _ray)
+  {
+    std::vector< std::pair< float, unsigned int > >* candidates = reinterpret_cast< ProxyRay& >(_ray).candidates;
+
+    bool found = false;
+    for(size_t index = 0; index < candidates->size() && !found; ++index)
+      found = (*candidates)[index].second == _ray.geomID;
+
+    if(!found)
+      candidates->push_back(std::make_pair(0.f, _ray.geomID));
+
+    _ray.geomID = RTC_INVALID_GEOMETRY_ID;
+  }
+}
+
+struct GeometryCache::CachePage
+{
+  CachePage()
+    : rtc_mesh(NULL)
+    , stamp(0)
+    , requested(false)
+  {;}
+
+  boost::shared_ptr< PolygonObject > mesh;
+  size_t bundle_mesh;
+  size_t bytes;
+  Vector3f lower;
+  Vector3f upper;
+
+  boost::atomic< RTCScene > rtc_mesh;
+  boost::atomic< size_t > stamp;
+  boost::atomic< bool > requested;
+  boost::mutex mutex;
+};
+
+struct GeometryCache::CacheBuild
+{
+  CachePage* page;
+  int scene_flags;
+
+  void operator()() const
+  {
+    RTCScene rtc_mesh = rtcNewScene(scene_flags, RTC_INTERSECT1);
+
+    unsigned int geom_id = rtcNewTriangleMesh(
+      rtc_mesh,
+      RTC_GEOMETRY_STATIC,
+      page->mesh->triangles(),
+      page->mesh->vertices()
+      );
+
+    rtcSetBuffer(
+      rtc_mesh,
+      geom_id,
+      RTC_VERTEX_BUFFER,
+      const_cast< float* >(page->mesh->positions()),
+      0,
+      3 * sizeof(float)
+      );
+
+    rtcSetBuffer(
+      rtc_mesh,
+      geom_id,
+      RTC_INDEX_BUFFER,
+      const_cast< unsigned int* >(page->mesh->indices()),
+      0,
+      3 * sizeof(unsigned int)
+      );
+
+    rtcCommit(rtc_mesh);
+
+    page->rtc_mesh.store(rtc_mesh, boost::memory_order_release);
+  }
+};
+
+struct GeometryCache::CacheLoading
+{
+  GeometryCache* cache;
+  const std::vector< size_t >* pages;
+
+  void operator()(const size_t _index) const
+  {
+    cache->fetch((*pages)[_index]);
+  }
+};
+
+GeometryCache::GeometryCache(const boost::shared_ptr< SceneBundle >& _bundle, const float _budget, const int _scene_flags)
+  : m_bundle(_bundle)
+  , m_budget(_budget * 1024.f * 1024.f)
+  , m_scene_flags(_scene_flags)
+  , m_stamp(0)
+  , m_evictions(0)
+  , m_resident(0)
+  , m_peak(0)
+  , m_builds(0)
+{;}
+
+GeometryCache::~GeometryCache()
+{
+  for(size_t index = 0; index < m_pages.size(); ++index)
+  {
+    RTCScene rtc_mesh = m_pages[index]->rtc_mesh.load();
+    if(rtc_mesh != NULL)
+      rtcDeleteScene(rtc_mesh);
+  }
+}
+
+size_t GeometryCache::page(const boost::shared_ptr< PolygonObject >& _mesh, const size_t _bundle_mesh)
+{
+  const BundleMesh& mesh = m_bundle->mesh(_bundle_mesh);
+
+  boost::shared_ptr< CachePage > page(new CachePage);
+  page->mesh = _mesh;
+  page->bundle_mesh = _bundle_mesh;
+  page->bytes = mesh.positions_size * sizeof(float)
+    + mesh.normals_size * sizeof(boost::uint32_t)
+    + mesh.texcoords_size * mesh.texcoord_bits / 8
+    + mesh.indices_size * sizeof(unsigned int);
+  page->lower = Vector3f(mesh.lower[0], mesh.lower[1], mesh.lower[2]);
+  page->upper = Vector3f(mesh.upper[0], mesh.upper[1], mesh.upper[2]);
+
+  m_pages.push_back(page);
+  return m_pages.size() - 1;
+}
+
+unsigned int GeometryCache::proxy(RTCScene _scene, const size_t _page, const Affine3f& _transform)
+{
+  const CachePage& page = *m_pages[_page];
+
+  unsigned int geom_id = rtcNewTriangleMesh(_scene, RTC_GEOMETRY_STATIC, 12, 8);
+
+  float* positions = static_cast< float* >(rtcMapBuffer(_scene, geom_id, RTC_VERTEX_BUFFER));
+  for(size_t corner = 0; corner < 8; ++corner)
+  {
+    Vector3f local(
+      (corner & 1) ? page.upper.x() : page.lower.x(),
+      (corner & 2) ? page.upper.y() : page.lower.y(),
+      (corner & 4) ? page.upper.z() : page.lower.z()
+      );
+
+    Vector3f world = _transform * local;
+    positions[4 * corner + 0] = world.x();
+    positions[4 * corner + 1] = world.y();
+    positions[4 * corner + 2] = world.z();
+    positions[4 * corner + 3] = 0.f;
+  }
+  rtcUnmapBuffer(_scene, geom_id, RTC_VERTEX_BUFFER);
+
+  unsigned int* indices = static_cast< unsigned int* >(rtcMapBuffer(_scene, geom_id, RTC_INDEX_BUFFER));
+  std::copy(box_indices, box_indices + 36, indices);
+  rtcUnmapBuffer(_scene, geom_id, RTC_INDEX_BUFFER);
+
+  rtcSetIntersectionFilterFunction(_scene, geom_id, &proxyFilter);
+
+  // Rays are brought into the space of the page to intersect it
+  Affine3f inverse = _transform.inverse();
+
+  if(geom_id >= m_proxies.size())
+    m_proxies.resize(geom_id + 1);
+
+  m_proxies[geom_id].page = _page;
+  m_proxies[geom_id].linear = inverse.linear();
+  m_proxies[geom_id].translation = inverse.translation();
+
+  return geom_id;
+}
+
+void GeometryCache::request(RTCScene _scene, const RTCRay& _ray)
+{
+  RTCRay ray = _ray;
+  Candidates& candidates = m_candidates.local();
+  gather(_scene, ray, &candidates);
+
+  for(size_t index = 0; index < candidates.size(); ++index)
+  {
+    CachePage& page = *m_pages[m_proxies[candidates[index].second].page];
+    if(!page.requested.load(boost::memory_order_relaxed))
+      page.requested.store(true, boost::memory_order_relaxed);
+  }
+}
+
+void GeometryCache::update()
+{
+  ++m_stamp;
+
+  std::vector< size_t > requested;
+  size_t required = 0;
+  for(size_t index = 0; index < m_pages.size(); ++index)
+  {
+    CachePage& page = *m_pages[index];
+    if(!page.requested.load(boost::memory_order_relaxed))
+      continue;
+
+    page.requested.store(false, boost::memory_order_relaxed);
+    page.stamp.store(m_stamp, boost::memory_order_relaxed);
+
+    if(page.rtc_mesh.load() == NULL)
+    {
+      requested.push_back(index);
+      required += page.bytes;
+    }
+  }
+
+  // Pages that have gone unused for longest are released first
+  if(m_resident.load() + required > m_budget)
+  {
+    std::vector< std::pair< size_t, size_t > > cold;
+    for(size_t index = 0; index < m_pages.size(); ++index)
+    {
+      const CachePage& page = *m_pages[index];
+      if(page.rtc_mesh.load() != NULL && page.stamp.load(boost::memory_order_relaxed) != m_stamp)
+        cold.push_back(std::make_pair(page.stamp.load(boost::memory_order_relaxed), index));
+    }
+
+    std::sort(cold.begin(), cold.end());
+    for(size_t index = 0; index < cold.size() && m_resident.load() + required > m_budget; ++index)
+      evict(cold[index].second);
+  }
+
+  CacheLoading loading;
+  loading.cache = this;
+  loading.pages = &requested;
+  tbb::parallel_for(size_t(0), requested.size(), loading);
+}
+
+void GeometryCache::intersect(RTCScene _scene, RTCRay& _ray)
+{
+  Candidates& candidates = m_candidates.local();
+  gather(_scene, _ray, &candidates);
+
+  // Candidates are visited front to back until the closest hit lies before the next proxy
+  for(size_t index = 0; index < candidates.size() && candidates[index].first <= _ray.tfar; ++index)
+  {
+    const CacheProxy& proxy = m_proxies[candidates[index].second];
+
+    RTCRay local = _ray;
+    Vector3fMap(local.org) = proxy.linear * Vector3fMap(_ray.org) + proxy.translation;
+    Vector3fMap(local.dir) = proxy.linear * Vector3fMap(_ray.dir);
+    local.geomID = RTC_INVALID_GEOMETRY_ID;
+    local.primID = RTC_INVALID_GEOMETRY_ID;
+    local.instID = RTC_INVALID_GEOMETRY_ID;
+
+    rtcIntersect(fetch(proxy.page), local);
+
+    // Distances along the untransformed direction are the same in both spaces
+    if(local.geomID != RTC_INVALID_GEOMETRY_ID)
+    {
+      _ray.tfar = local.tfar;
+      _ray.Ng[0] = local.Ng[0];
+      _ray.Ng[1] = local.Ng[1];
+      _ray.Ng[2] = local.Ng[2];
+      _ray.u = local.u;
+      _ray.v = local.v;
+      _ray.geomID = candidates[index].second;
+      _ray.primID = local.primID;
+      _ray.instID = RTC_INVALID_GEOMETRY_ID;
+    }
+  }
+}
+
+void GeometryCache::occluded(RTCScene _scene, RTCRay& _ray)
+{
+  RTCRay ray = _ray;
+  Candidates& candidates = m_candidates.local();
+  gather(_scene, ray, &candidates);
+
+  for(size_t index = 0; index < candidates.size(); ++index)
+  {
+    const CacheProxy& proxy = m_proxies[candidates[index].second];
+
+    RTCRay local = _ray;
+    Vector3fMap(local.org) = proxy.linear * Vector3fMap(_ray.org) + proxy.translation;
+    Vector3fMap(local.dir) = proxy.linear * Vector3fMap(_ray.dir);
+
+    rtcOccluded(fetch(proxy.page), local);
+
+    if(local.geomID == 0)
+    {
+      _ray.geomID = 0;
+      return;
+    }
+  }
+}
+
+void GeometryCache::gather(RTCScene _scene, RTCRay& _ray, Candidates* _candidates) const
+{
+  _candidates->clear();
+
+  ProxyRay proxy_ray;
+  proxy_ray.rtc_ray = _ray;
+  proxy_ray.candidates = _candidates;
+
+  rtcIntersect(_scene, proxy_ray.rtc_ray);
+
+  // Only lights are hit directly as every proxy is rejected
+  if(proxy_ray.rtc_ray.geomID != RTC_INVALID_GEOMETRY_ID)
+    _ray = proxy_ray.rtc_ray;
+
+  // Entry distances come from the bounds of each page so that rays starting inside one still visit it first
+  for(size_t index = 0; index < _candidates->size(); ++index)
+  {
+    const CacheProxy& proxy = m_proxies[(*_candidates)[index].second];
+    const CachePage& page = *m_pages[proxy.page];
+
+    Vector3f origin = proxy.linear * Vector3fMap(_ray.org) + proxy.translation;
+    Vector3f direction = proxy.linear * Vector3fMap(_ray.dir);
+
+    float entry = _ray.tnear;
+    for(size_t axis = 0; axis < 3; ++axis)
+    {
+      float inverse = 1.f / direction[axis];
+      float lower = (page.lower[axis] - origin[axis]) * inverse;
+      float upper = (page.upper[axis] - origin[axis]) * inverse;
+      entry = std::max(entry, std::min(lower, upper));
+    }
+
+    (*_candidates)[index].first = entry;
+  }
+
+  std::sort(_candidates->begin(), _candidates->end());
+}
+
+RTCScene GeometryCache::fetch(const size_t _page)
+{
+  CachePage& page = *m_pages[_page];
+  page.stamp.store(m_stamp, boost::memory_order_relaxed);
+
+  RTCScene rtc_mesh = page.rtc_mesh.load(boost::memory_order_acquire);
+  if(rtc_mesh != NULL)
+    return rtc_mesh;
+
+  boost::mutex::scoped_lock lock(page.mutex);
+
+  rtc_mesh = page.rtc_mesh.load(boost::memory_order_acquire);
+  if(rtc_mesh == NULL)
+  {
+    // Building is isolated so this thread cannot pick up another ray waiting on the same lock
+    CacheBuild build;
+    build.page = &page;
+    build.scene_flags = m_scene_flags;
+    tbb::this_task_arena::isolate(build);
+
+    rtc_mesh = page.rtc_mesh.load(boost::memory_order_acquire);
+    m_builds.fetch_add(1);
+
+    // Builds on demand may go over the budget until the next update releases cold pages
+    size_t resident = m_resident.fetch_add(page.bytes) + page.bytes;
+    size_t peak = m_peak.load(boost::memory_order_relaxed);
+    while(resident > peak)
+    {
+      if(m_peak.compare_exchange_weak(peak, resident, boost::memory_order_relaxed))
+        break;
+    }
+  }
+
+  return rtc_mesh;
+}
+
+void GeometryCache::evict(const size_t _page)
+{
+  CachePage& page = *m_pages[_page];
+
+  rtcDeleteScene(page.rtc_mesh.exchange(NULL));
+  m_resident.fetch_sub(page.bytes);
+  m_bundle->release(page.bundle_mesh);
+
+  ++m_evictions;
+}
+
+MSC_NAMESPACE_END
@@ -0,0 +1,78 @@
+#include <core/InstanceObject.h>
+
+MSC_NAMESPACE_BEGIN
+
+void InstanceObject::construct()
+{
+  Affine3f transform = Affine3f::Identity()
+   * Eigen::Translation3f(m_translation)
+   * Eigen::AngleAxisf(m_rotation.x() * M_PI_180, Vector3f::UnitX())
+   * Eigen::AngleAxisf(m_rotation.y() * M_PI_180, Vector3f::UnitY())
+   * Eigen::AngleAxisf(m_rotation.z() * M_PI_180, Vector3f::UnitZ())
+   * Eigen::AlignedScaling3f(m_scale);
+
+  for(size_t column = 0; column < 4; ++column)
+  {
+    for(size_t row = 0; row < 3; ++row)
+      m_transform[3 * column + row] = transform.matrix()(row, column);
+  }
+
+  m_linear = transform.linear();
+  m_normal_transform = m_linear.inverse().transpose();
+}
+
+void InstanceObject::texture(
+  const size_t _primitive,
+  const float _s,
+  const float _t,
+  Vector2f* _output
+  ) const
+{
+  m_mesh->texture(_primitive, _s, _t, _output);
+}
+
+float InstanceObject::density(const size_t _primitive) const
+{
+  return m_mesh->density(_primitive, m_linear);
+}
+
+void InstanceObject::interpolateTexcoords(
+  const size_t _size,
+  const int* _primitives,
+  const float* _s,
+  const float* _t,
+  float* _u,
+  float* _v,
+  float* _density
+  ) const
+{
+  m_mesh->interpolateTexcoords(_size, _primitives, _s, _t, m_linear, _u, _v, _density);
+}
+
+void InstanceObject::interpolateNormals(
+  const size_t _size,
+  const int* _primitives,
+  const float* _s,
+  const float* _t,
+  float* _x,
+  float* _y,
+  float* _z
+  ) const
+{
+  m_mesh->interpolateNormals(_size, _primitives, _s, _t, _x, _y, _z);
+
+  for(size_t index = 0; index < _size; ++index)
+  {
+    Vector3f normal = m_normal_transform * Vector3f(_x[index], _y[index], _z[index]);
+    _x[index] = normal.x();
+    _y[index] = normal.y();
+    _z[index] = normal.z();
+  }
+}
+
+Vector3f InstanceObject::worldNormal(const Vector3f& _normal) const
+{
+  return m_normal_transform * _normal;
+}
+
+MSC_NAMESPACE_END
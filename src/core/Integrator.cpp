@@ -6,16 +6,26 @@
 #include <core/ObjectInterface.h>
 #include <core/ShaderInterface.h>
 #include <core/LightInterface.h>
+#include <core/Prefetch.h>
 
 MSC_NAMESPACE_BEGIN
 
 void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
 {
-  LocalRandomGenerator::reference random = m_local_thread_storage_random->local();
-  LocalTextureSystem::reference texture_system = m_local_thread_storage_texture->local();
+  RandomGenerator random;
+  LocalTexturePerthread::reference texture_info = m_local_thread_storage_texture->local();
+  LocalContributions::reference contributions = m_local_thread_storage_contributions->local();
+  LocalDepthHistogram::reference histogram = m_local_thread_storage_histogram->local();
   
-  if(texture_system == NULL)
-    texture_system = OpenImageIO::TextureSystem::create(true);
+  if(histogram.size() < m_settings->max_depth + 1)
+    histogram.resize(m_settings->max_depth + 1, 0);
+
+  if(texture_info == NULL)
+    texture_info = m_texture_system->get_perthread_info();
+
+  // Prefetching skips ranges once shading has reached them
+  if(m_prefetch != NULL)
+    m_prefetch->shading(r.begin());
 
   size_t range_size = (r.end() - r.begin());
   size_t geom_id = m_batch[r.begin()].geomID;
@@ -24,7 +34,12 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
 
   // If nothing was hit
   if(geom_id == -1)
+  {
+    for(size_t index = r.begin(); index < r.end(); ++index)
+      histogram[m_batch[index].rayDepth] += 1;
+
     return;
+  }
 
   ObjectInterface* object = m_scene->objects[geom_id].get();
 
@@ -40,6 +55,8 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
 
     for(size_t index = r.begin(); index < r.end(); ++index)
     {
+      histogram[m_batch[index].rayDepth] += 1;
+
       Vector3f ray_direction = Vector3f(
         m_batch[index].dir[0],
         m_batch[index].dir[1],
@@ -63,12 +80,12 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
 
       if(light_radiance.matrix().maxCoeff() > M_EPSILON)
       {
-        m_image->samples[m_batch[index].sampleID].r += light_radiance[0]
-         * mis_balance * m_batch[index].weight[0];
-        m_image->samples[m_batch[index].sampleID].g += light_radiance[1]
-         * mis_balance * m_batch[index].weight[1];
-        m_image->samples[m_batch[index].sampleID].b += light_radiance[2]
-         * mis_balance * m_batch[index].weight[2];
+        Contribution contribution;
+        contribution.sampleID = m_batch[index].sampleID;
+        contribution.r = light_radiance[0] * mis_balance * m_batch[index].weight[0];
+        contribution.g = light_radiance[1] * mis_balance * m_batch[index].weight[1];
+        contribution.b = light_radiance[2] * mis_balance * m_batch[index].weight[2];
+        contributions.push_back(contribution);
       }
     }
 
@@ -79,24 +96,13 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
 
   // Compute shader coefficients 
   {
-    std::vector< float > u(range_size);
-    std::vector< float > v(range_size);
-
-    for(size_t index = 0; index < range_size; ++index)
-    {
-      Vector2f texture;
-      object->texture(
-        m_batch[r.begin() + index].primID,
-        m_batch[r.begin() + index].u,
-        m_batch[r.begin() + index].v,
-        &texture
-        );
+    std::vector< float > u;
+    std::vector< float > v;
+    std::vector< float > footprint;
 
-      u[index] = texture[0];
-      v[index] = texture[1];
-    }
+    coordinates(object, &(m_batch[r.begin()]), range_size, 1, &u, &v, &footprint);
 
-    shader->initialize(range_size, u, v, texture_system);
+    shader->initialize(range_size, u, v, footprint, m_texture_system, texture_info);
   }
 
   // Next event estimation
@@ -105,7 +111,13 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
     {
       size_t colour_index = index - r.begin();
 
-      size_t ligt_identifier = size_t(light_count * random.sample());
+      random.sequence(
+        pathKey(m_batch[index].sampleID / m_samples, m_batch[index].rayDepth),
+        m_iteration * m_samples + m_batch[index].sampleID % m_samples,
+        DIMENSION_LIGHT_PICK
+        );
+
+      size_t ligt_identifier = std::min(light_count - 1, size_t(light_count * random.sample()));
       LightInterface* light = m_scene->lights[ligt_identifier].get();
 
       Vector3f ray_origin = Vector3f(
@@ -118,11 +130,11 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
         m_batch[index].dir[1],
         m_batch[index].dir[2]
         ).normalized();
-      Vector3f normal = Vector3f(
+      Vector3f normal = object->worldNormal(Vector3f(
         m_batch[index].Ng[0],
         m_batch[index].Ng[1],
         m_batch[index].Ng[2]
-        ).normalized() * -1.f;
+        )).normalized() * -1.f;
       Vector3f position = ray_origin + ray_direction * m_batch[index].tfar;
       Vector3f output_dir = ray_direction * -1.f;
       Vector3f input_dir;
@@ -131,6 +143,7 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
       float light_pdfw;
       float distance;
 
+      random.dimension(DIMENSION_LIGHT);
       light->illuminate(&random, position, &input_dir, &distance, &light_radiance, &light_pdfw);
 
       if(light_radiance.matrix().maxCoeff() > M_EPSILON)
@@ -164,13 +177,19 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
           shadow_ray.dir[0] = input_dir[0];
           shadow_ray.dir[1] = input_dir[1];
           shadow_ray.dir[2] = input_dir[2];
-          rtcOccluded(m_scene->rtc_scene, shadow_ray.rtc_ray);
+          if(m_scene->geometry_cache)
+            m_scene->geometry_cache->occluded(m_scene->rtc_scene, shadow_ray.rtc_ray);
+          else
+            rtcOccluded(m_scene->rtc_scene, shadow_ray.rtc_ray);
 
           if(shadow_ray.geomID != 0)
           {
-            m_image->samples[m_batch[index].sampleID].r += contribution[0] * m_batch[index].weight[0];
-            m_image->samples[m_batch[index].sampleID].g += contribution[1] * m_batch[index].weight[1];
-            m_image->samples[m_batch[index].sampleID].b += contribution[2] * m_batch[index].weight[2];
+            Contribution sample_contribution;
+            sample_contribution.sampleID = m_batch[index].sampleID;
+            sample_contribution.r = contribution[0] * m_batch[index].weight[0];
+            sample_contribution.g = contribution[1] * m_batch[index].weight[1];
+            sample_contribution.b = contribution[2] * m_batch[index].weight[2];
+            contributions.push_back(sample_contribution);
           }
         }
       }
@@ -182,16 +201,10 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
     for(size_t index = r.begin(); index < r.end(); ++index)
     {
       if(m_batch[index].rayDepth >= m_settings->max_depth)
+      {
+        histogram[m_batch[index].rayDepth] += 1;
         continue;
-
-      float tentative_contrib = shader->continuation();
-      float cont_probability = fmin(1.f, tentative_contrib / m_settings->threshold);
-
-      if(m_batch[index].rayDepth < m_settings->min_depth)
-        cont_probability = 1.f;
-
-      if(random.sample() > cont_probability)
-        continue;
+      }
 
       size_t colour_index = index - r.begin();
 
@@ -205,11 +218,11 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
         m_batch[index].dir[1],
         m_batch[index].dir[2]
         ).normalized();
-      Vector3f normal = Vector3f(
+      Vector3f normal = object->worldNormal(Vector3f(
         m_batch[index].Ng[0],
         m_batch[index].Ng[1],
         m_batch[index].Ng[2]
-        ).normalized() * -1.f;
+        )).normalized() * -1.f;
       Vector3f position = ray_origin + ray_direction * m_batch[index].tfar;
       Vector3f output_dir = ray_direction * -1.f;
       Vector3f input_dir;
@@ -218,8 +231,35 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
       float bsdf_pdfw;
       float cos_theta;
 
+      random.sequence(
+        pathKey(m_batch[index].sampleID / m_samples, m_batch[index].rayDepth),
+        m_iteration * m_samples + m_batch[index].sampleID % m_samples,
+        DIMENSION_BSDF
+        );
+
       shader->sample(&random, colour_index, output_dir, normal, &input_dir, &bsdf_weight, &cos_theta, &bsdf_pdfw);
 
+      Colour3f throughput(0.f, 0.f, 0.f);
+      if(bsdf_pdfw > 0.f)
+      {
+        throughput = Colour3f(m_batch[index].weight[0], m_batch[index].weight[1], m_batch[index].weight[2])
+         * bsdf_weight * (cos_theta / bsdf_pdfw);
+      }
+
+      // Paths are terminated according to the throughput they would carry past this vertex
+      float cont_probability = fmin(1.f, m_settings->roulette_efficiency * throughput.maxCoeff() / m_settings->threshold);
+
+      if(m_batch[index].rayDepth < m_settings->min_depth)
+        cont_probability = 1.f;
+
+      random.dimension(DIMENSION_CONTINUATION);
+
+      if(throughput.maxCoeff() <= 0.f || random.sample() >= cont_probability)
+      {
+        histogram[m_batch[index].rayDepth] += 1;
+        continue;
+      }
+
       RayCompressed input_ray;
       input_ray.org[0] = position[0];
       input_ray.org[1] = position[1];
@@ -227,13 +267,12 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
       input_ray.dir[0] = input_dir[0];
       input_ray.dir[1] = input_dir[1];
       input_ray.dir[2] = input_dir[2];
-      input_ray.weight[0] = m_batch[index].weight[0]
-       * bsdf_weight[0] * (cos_theta / bsdf_pdfw) / cont_probability;
-      input_ray.weight[1] = m_batch[index].weight[1]
-       * bsdf_weight[1] * (cos_theta / bsdf_pdfw) / cont_probability;
-      input_ray.weight[2] = m_batch[index].weight[2]
-       * bsdf_weight[2] * (cos_theta / bsdf_pdfw) / cont_probability;
+      input_ray.weight[0] = throughput[0] / cont_probability;
+      input_ray.weight[1] = throughput[1] / cont_probability;
+      input_ray.weight[2] = throughput[2] / cont_probability;
       input_ray.lastPdf = bsdf_pdfw;
+      input_ray.coneWidth = m_batch[index].coneWidth + m_batch[index].coneSpread * m_batch[index].tfar;
+      input_ray.coneSpread = m_batch[index].coneSpread + lobeSpread(bsdf_pdfw);
       input_ray.rayDepth = m_batch[index].rayDepth + 1;
       input_ray.sampleID = m_batch[index].sampleID;
 
@@ -249,9 +288,51 @@ void Integrator::operator()(const RangeGeom< RayUncompressed* > &r) const
   {
     if(m_buffer.direction[index].size() > 0)
       m_bins->add(m_buffer.direction[index].size(), index, &(m_buffer.direction[index][0]), m_batch_queue);
+
+    m_buffer.direction[index].clear();
   }
 
   delete shader;
 }
 
+void Integrator::coordinates(
+  const ObjectInterface* _object,
+  const RayUncompressed* _hits,
+  const size_t _size,
+  const size_t _stride,
+  std::vector< float >* _u,
+  std::vector< float >* _v,
+  std::vector< float >* _footprint
+  )
+{
+  size_t count = (_size + _stride - 1) / _stride;
+  _u->resize(count);
+  _v->resize(count);
+  _footprint->resize(count);
+
+  if(count == 0)
+    return;
+
+  // Hit points are split into arrays so the whole range is interpolated in one call
+  std::vector< int > primitives(count);
+  std::vector< float > s(count);
+  std::vector< float > t(count);
+  for(size_t index = 0; index < count; ++index)
+  {
+    const RayUncompressed& hit = _hits[index * _stride];
+    primitives[index] = hit.primID;
+    s[index] = hit.u;
+    t[index] = hit.v;
+  }
+
+  _object->interpolateTexcoords(count, &(primitives[0]), &(s[0]), &(t[0]), &((*_u)[0]), &((*_v)[0]), &((*_footprint)[0]));
+
+  // Isotropic filter width from the ray cone at the hit point
+  for(size_t index = 0; index < count; ++index)
+  {
+    const RayUncompressed& hit = _hits[index * _stride];
+    (*_footprint)[index] *= hit.coneWidth + hit.coneSpread * hit.tfar;
+  }
+}
+
 MSC_NAMESPACE_END
\ No newline at end of file
@@ -4,19 +4,48 @@ MSC_NAMESPACE_BEGIN
 
 ShaderInterface* LambertShader::clone()
 {
-  LambertShader* shader = new LambertShader(*this);
-  shader->texture(m_texture->clone());
-  return shader;
+  return new LambertShader(*this);
 }
 
 void LambertShader::initialize(
   const size_t _size,
   std::vector< float >& _u,
   std::vector< float >& _v,
-  TextureSystem _texture_system
+  std::vector< float >& _footprint,
+  TextureSystem _texture_system,
+  TexturePerthread _thread_info
   )
 {
-  m_texture->initialize(_size, _u, _v, _texture_system);
+  m_size = _size;
+
+  if(!m_program->constant())
+    m_program->execute(_size, _u, _v, _footprint, _texture_system, _thread_info, &m_colour);
+}
+
+void LambertShader::prefetch(
+  const size_t _size,
+  const float* _u,
+  const float* _v,
+  const float* _footprint,
+  TextureSystem _texture_system,
+  TexturePerthread _thread_info
+  ) const
+{
+  if(!m_program->constant())
+    m_program->prefetch(_size, _u, _v, _footprint, _texture_system, _thread_info);
+}
+
+void LambertShader::preconvert(TextureConverter* _converter)
+{
+  m_texture->preconvert(_converter);
+}
+
+void LambertShader::resolve(TextureSystem _texture_system)
+{
+  m_texture->resolve(_texture_system);
+
+  m_program.reset(new TextureProgram);
+  m_program->compile(m_texture.get());
 }
 
 float LambertShader::continuation() const
@@ -40,7 +69,7 @@ void LambertShader::evaluate(
   if(cos_theta_input < 0.f || cos_theta_output < 0.f)
     *_weight = Colour3f(0.f, 0.f, 0.f);
   else
-    *_weight = m_texture->colour(_colour_index) * m_reflectance * M_INV_PI;
+    *_weight = colour(_colour_index) * m_reflectance * M_INV_PI;
 
   *_cos_theta = (cos_theta_input < 0.f) ? 0.f : cos_theta_input;
   *_direct_pdfw = *_cos_theta * M_INV_PI;
@@ -67,9 +96,17 @@ void LambertShader::sample(
   Vector3f t = _normal.cross(s).normalized();
 
   *_input = x * t + y * s + z * _normal;
-  *_weight = m_texture->colour(_colour_index) * m_reflectance * M_INV_PI;
+  *_weight = colour(_colour_index) * m_reflectance * M_INV_PI;
   *_cos_theta = _normal.dot(*_input);
   *_direct_pdfw = *_cos_theta * M_INV_PI;
 }
 
+Colour3f LambertShader::colour(const size_t _index) const
+{
+  if(m_program->constant())
+    return m_program->colour();
+
+  return Colour3f(m_colour[_index], m_colour[m_size + _index], m_colour[2 * m_size + _index]);
+}
+
 MSC_NAMESPACE_END
\ No newline at end of file
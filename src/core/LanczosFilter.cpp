@@ -0,0 +1,30 @@
+#include <core/LanczosFilter.h>
+
+MSC_NAMESPACE_BEGIN
+
+float LanczosFilter::radius() const
+{
+  return m_radius;
+}
+
+float LanczosFilter::evaluate(const float _distance) const
+{
+  float x = fabsf(_distance);
+
+  if(x > m_radius)
+    return 0.f;
+
+  return sinc(x) * sinc(x / m_tau);
+}
+
+float LanczosFilter::sinc(const float _x) const
+{
+  float x = fabsf(_x);
+
+  if(x < 1e-5f)
+    return 1.f;
+
+  return sinf(M_PI * x) / (M_PI * x);
+}
+
+MSC_NAMESPACE_END
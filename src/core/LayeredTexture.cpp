@@ -11,29 +11,42 @@ TextureInterface* LayeredTexture::clone()
   return texture;
 }
 
-void LayeredTexture::initialize(
-  const size_t _size,
-  std::vector< float >& _u,
-  std::vector< float >& _v,
-  TextureSystem _texture_system
-  )
+void LayeredTexture::preconvert(TextureConverter* _converter)
 {
-  m_upper->initialize(_size, _u, _v, _texture_system);
-  m_lower->initialize(_size, _u, _v, _texture_system);
-  m_mask->initialize(_size, _u, _v, _texture_system);
+  m_upper->preconvert(_converter);
+  m_lower->preconvert(_converter);
+  m_mask->preconvert(_converter);
+}
 
-  m_colour.resize(_size);
-  for(size_t index = 0; index < _size; ++index)
-  {
-    Colour3f mask = m_mask->colour(index);
-    Colour3f inverse = Colour3f(1.f, 1.f, 1.f) - mask;
-    m_colour[index] = (m_upper->colour(index) * mask) + (m_lower->colour(index) * inverse);
-  }
+void LayeredTexture::resolve(TextureSystem _texture_system)
+{
+  m_upper->resolve(_texture_system);
+  m_lower->resolve(_texture_system);
+  m_mask->resolve(_texture_system);
 }
 
-Colour3f LayeredTexture::colour(const size_t _index) const
+TextureOperand LayeredTexture::compile(TextureProgram* _program, const size_t _runflags) const
 {
-  return m_colour[_index];
+  TextureOperand mask = m_mask->compile(_program, _runflags);
+
+  // Constant masks that select a single layer prune the other one entirely
+  if(mask.constant)
+  {
+    if((mask.colour == 1.f).all())
+      return m_upper->compile(_program, _runflags);
+
+    if((mask.colour == 0.f).all())
+      return m_lower->compile(_program, _runflags);
+
+    TextureOperand upper = m_upper->compile(_program, _runflags);
+    TextureOperand lower = m_lower->compile(_program, _runflags);
+    return _program->blend(upper, lower, mask);
+  }
+
+  // Each layer is only evaluated where the mask leaves it visible
+  TextureOperand upper = m_upper->compile(_program, _program->runflags(mask, _runflags, false));
+  TextureOperand lower = m_lower->compile(_program, _program->runflags(mask, _runflags, true));
+  return _program->blend(upper, lower, mask);
 }
 
-MSC_NAMESPACE_END
\ No newline at end of file
+MSC_NAMESPACE_END
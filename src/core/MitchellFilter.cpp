@@ -0,0 +1,26 @@
+#include <core/MitchellFilter.h>
+
+MSC_NAMESPACE_BEGIN
+
+float MitchellFilter::radius() const
+{
+  return m_radius;
+}
+
+float MitchellFilter::evaluate(const float _distance) const
+{
+  // Profile is defined over [-2, 2] so it is scaled to fit the radius
+  float x = fabsf(2.f * _distance / m_radius);
+
+  if(x > 2.f)
+    return 0.f;
+
+  if(x > 1.f)
+    return ((-m_b - 6.f * m_c) * x * x * x + (6.f * m_b + 30.f * m_c) * x * x +
+      (-12.f * m_b - 48.f * m_c) * x + (8.f * m_b + 24.f * m_c)) * (1.f / 6.f);
+
+  return ((12.f - 9.f * m_b - 6.f * m_c) * x * x * x + (-18.f + 12.f * m_b + 6.f * m_c) * x * x +
+    (6.f - 2.f * m_b)) * (1.f / 6.f);
+}
+
+MSC_NAMESPACE_END
@@ -11,12 +11,36 @@ void NullShader::initialize(
   const size_t _size,
   std::vector< float >& _u,
   std::vector< float >& _v,
-  TextureSystem _texture_system
+  std::vector< float >& _footprint,
+  TextureSystem _texture_system,
+  TexturePerthread _thread_info
   )
 {
   // Nothing to initialize
 }
 
+void NullShader::prefetch(
+  const size_t _size,
+  const float* _u,
+  const float* _v,
+  const float* _footprint,
+  TextureSystem _texture_system,
+  TexturePerthread _thread_info
+  ) const
+{
+  // Nothing to prefetch
+}
+
+void NullShader::preconvert(TextureConverter* _converter)
+{
+  // Nothing to convert
+}
+
+void NullShader::resolve(TextureSystem _texture_system)
+{
+  // Nothing to resolve
+}
+
 float NullShader::continuation() const
 {
   return 1.f;
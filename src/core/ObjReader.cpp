@@ -0,0 +1,678 @@
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+#include <tbb/tbb.h>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <core/ObjReader.h>
+#include <core/Sequence.h>
+
+MSC_NAMESPACE_BEGIN
+
+namespace
+{
+  const size_t chunk_size = 1 << 20;
+  const size_t block_size = 65536;
+  const unsigned int empty_slot = 0xFFFFFFFF;
+
+  enum Statement
+  {
+    OTHER,
+    POSITION,
+    TEXCOORD,
+    NORMAL,
+    FACE
+  };
+
+  // Absolute position, texture and normal index of a face corner where missing values are negative
+  struct Corner
+  {
+    int v, vt, vn;
+  };
+
+  inline bool operator==(const Corner& _lhs, const Corner& _rhs)
+  {
+    return _lhs.v == _rhs.v && _lhs.vt == _rhs.vt && _lhs.vn == _rhs.vn;
+  }
+
+  inline size_t hash(const Corner& _corner)
+  {
+    boost::uint64_t key = boost::uint32_t(_corner.v);
+    key = key * 0x9E3779B97F4A7C15ULL + boost::uint32_t(_corner.vt);
+    key = key * 0x9E3779B97F4A7C15ULL + boost::uint32_t(_corner.vn);
+    return mixBits(key);
+  }
+
+  // Range of lines, the counts are replaced by offsets into the shared arrays once summed
+  struct Chunk
+  {
+    const char* begin;
+    const char* end;
+    size_t positions;
+    size_t texcoords;
+    size_t normals;
+    size_t triangles;
+    bool valid;
+  };
+
+  inline bool space(const char _c)
+  {
+    return (_c == ' ') || (_c == '\t');
+  }
+
+  inline bool separator(const char _c)
+  {
+    return (_c == ' ') || (_c == '\t') || (_c == '\n') || (_c == '\r');
+  }
+
+  inline const char* nextLine(const char* _p, const char* _end)
+  {
+    while(_p < _end && *_p != '\n')
+      ++_p;
+    return (_p < _end) ? _p + 1 : _p;
+  }
+
+  // Skips white space and returns whether another token remains on the line
+  inline bool token(const char*& _p, const char* _end)
+  {
+    while(_p < _end && space(*_p))
+      ++_p;
+    return (_p < _end) && !separator(*_p) && (*_p != '#');
+  }
+
+  inline void skipToken(const char*& _p, const char* _end)
+  {
+    while(_p < _end && !separator(*_p))
+      ++_p;
+  }
+
+  Statement statement(const char*& _p, const char* _end)
+  {
+    while(_p < _end && space(*_p))
+      ++_p;
+
+    if(_end - _p < 2)
+      return OTHER;
+
+    if(_p[0] == 'v')
+    {
+      if(space(_p[1]))
+      {
+        _p += 2;
+        return POSITION;
+      }
+
+      if(_end - _p > 2 && space(_p[2]))
+      {
+        if(_p[1] == 't')
+        {
+          _p += 3;
+          return TEXCOORD;
+        }
+
+        if(_p[1] == 'n')
+        {
+          _p += 3;
+          return NORMAL;
+        }
+      }
+    }
+    else if(_p[0] == 'f' && space(_p[1]))
+    {
+      _p += 2;
+      return FACE;
+    }
+
+    return OTHER;
+  }
+
+  float parseFloat(const char*& _p, const char* _end)
+  {
+    if(!token(_p, _end))
+      return 0.f;
+
+    bool negative = false;
+    if(*_p == '-' || *_p == '+')
+      negative = (*(_p++) == '-');
+
+    double mantissa = 0.0;
+    int exponent = 0;
+
+    for(; _p < _end && *_p >= '0' && *_p <= '9'; ++_p)
+      mantissa = mantissa * 10.0 + (*_p - '0');
+
+    if(_p < _end && *_p == '.')
+    {
+      for(++_p; _p < _end && *_p >= '0' && *_p <= '9'; ++_p, --exponent)
+        mantissa = mantissa * 10.0 + (*_p - '0');
+    }
+
+    if(_p < _end && (*_p == 'e' || *_p == 'E'))
+    {
+      ++_p;
+      bool negative_exponent = false;
+      if(_p < _end && (*_p == '-' || *_p == '+'))
+        negative_exponent = (*(_p++) == '-');
+
+      int value = 0;
+      for(; _p < _end && *_p >= '0' && *_p <= '9'; ++_p)
+        value = std::min(value * 10 + (*_p - '0'), 1000);
+
+      exponent += negative_exponent ? -value : value;
+    }
+
+    skipToken(_p, _end);
+
+    double result = (exponent != 0) ? mantissa * std::pow(10.0, exponent) : mantissa;
+    return float(negative ? -result : result);
+  }
+
+  // Indices that are left out of a corner and indices that can never be resolved
+  const int missing_index = -1;
+  const int invalid_index = -2;
+
+  // Parses an index and resolves it against the number of elements read so far
+  int parseIndex(const char*& _p, const char* _end, const size_t _count)
+  {
+    bool negative = false;
+    if(_p < _end && (*_p == '-' || *_p == '+'))
+      negative = (*(_p++) == '-');
+
+    long value = 0;
+    bool digits = false;
+    for(; _p < _end && *_p >= '0' && *_p <= '9'; ++_p, digits = true)
+      value = std::min(value * 10 + (*_p - '0'), long(std::numeric_limits< int >::max()) + 1);
+
+    if(!digits)
+      return negative ? invalid_index : missing_index;
+
+    long index = negative ? long(_count) - value : value - 1;
+    if(value == 0 || index < 0 || index > std::numeric_limits< int >::max())
+      return invalid_index;
+
+    return int(index);
+  }
+
+  Corner parseCorner(
+    const char*& _p,
+    const char* _end,
+    const size_t _positions,
+    const size_t _texcoords,
+    const size_t _normals
+    )
+  {
+    Corner corner;
+    corner.v = parseIndex(_p, _end, _positions);
+    corner.vt = missing_index;
+    corner.vn = missing_index;
+
+    if(_p < _end && *_p == '/')
+    {
+      ++_p;
+      if(_p < _end && *_p != '/')
+        corner.vt = parseIndex(_p, _end, _texcoords);
+
+      if(_p < _end && *_p == '/')
+      {
+        ++_p;
+        corner.vn = parseIndex(_p, _end, _normals);
+      }
+    }
+
+    skipToken(_p, _end);
+
+    return corner;
+  }
+
+  // Counts the elements within each chunk
+  struct ChunkCount
+  {
+    Chunk* chunks;
+
+    void operator()(const size_t _chunk) const
+    {
+      Chunk& chunk = chunks[_chunk];
+      chunk.positions = chunk.texcoords = chunk.normals = chunk.triangles = 0;
+      chunk.valid = true;
+
+      const char* p = chunk.begin;
+      while(p < chunk.end)
+      {
+        switch(statement(p, chunk.end))
+        {
+          case POSITION: chunk.positions += 1; break;
+          case TEXCOORD: chunk.texcoords += 1; break;
+          case NORMAL: chunk.normals += 1; break;
+          case FACE:
+          {
+            size_t size = 0;
+            for(; token(p, chunk.end); ++size)
+              skipToken(p, chunk.end);
+
+            if(size > 2)
+              chunk.triangles += size - 2;
+            break;
+          }
+          default: break;
+        }
+
+        p = nextLine(p, chunk.end);
+      }
+    }
+  };
+
+  // Parses each chunk into the shared arrays at its offsets
+  struct ChunkParse
+  {
+    Chunk* chunks;
+    size_t total_positions;
+    size_t total_texcoords;
+    size_t total_normals;
+    float* positions;
+    float* texcoords;
+    float* normals;
+    Corner* corners;
+
+    void operator()(const size_t _chunk) const
+    {
+      Chunk& chunk = chunks[_chunk];
+      size_t position = chunk.positions;
+      size_t texcoord = chunk.texcoords;
+      size_t normal = chunk.normals;
+      size_t corner = 3 * chunk.triangles;
+
+      std::vector< Corner > polygon;
+
+      const char* p = chunk.begin;
+      while(p < chunk.end)
+      {
+        switch(statement(p, chunk.end))
+        {
+          case POSITION:
+          {
+            for(size_t i = 0; i < 3; ++i)
+              positions[3 * position + i] = parseFloat(p, chunk.end);
+            position += 1;
+            break;
+          }
+          case TEXCOORD:
+          {
+            for(size_t i = 0; i < 2; ++i)
+              texcoords[2 * texcoord + i] = parseFloat(p, chunk.end);
+            texcoord += 1;
+            break;
+          }
+          case NORMAL:
+          {
+            for(size_t i = 0; i < 3; ++i)
+              normals[3 * normal + i] = parseFloat(p, chunk.end);
+            normal += 1;
+            break;
+          }
+          case FACE:
+          {
+            polygon.clear();
+            while(token(p, chunk.end))
+            {
+              Corner current = parseCorner(p, chunk.end, position, texcoord, normal);
+
+              // Files with invalid references are rejected before any corner is resolved
+              if(current.v < 0 || size_t(current.v) >= total_positions
+                || (current.vt != missing_index && (current.vt < 0 || size_t(current.vt) >= total_texcoords))
+                || (current.vn != missing_index && (current.vn < 0 || size_t(current.vn) >= total_normals)))
+                chunk.valid = false;
+
+              polygon.push_back(current);
+            }
+
+            for(size_t i = 2; i < polygon.size(); ++i)
+            {
+              corners[corner++] = polygon[0];
+              corners[corner++] = polygon[i - 1];
+              corners[corner++] = polygon[i];
+            }
+            break;
+          }
+          default: break;
+        }
+
+        p = nextLine(p, chunk.end);
+      }
+    }
+  };
+
+  // Inserts corners into the table keeping the lowest index of every unique corner
+  struct CornerInsert
+  {
+    const Corner* corners;
+    boost::atomic< unsigned int >* table;
+    size_t mask;
+
+    void operator()(const tbb::blocked_range< size_t >& r) const
+    {
+      for(size_t index = r.begin(); index < r.end(); ++index)
+      {
+        unsigned int value = static_cast< unsigned int >(index);
+        size_t slot = hash(corners[index]) & mask;
+
+        while(true)
+        {
+          unsigned int current = empty_slot;
+          if(table[slot].compare_exchange_strong(current, value))
+            break;
+
+          // Lower the stored index when the corner is already present
+          if(corners[current] == corners[index])
+          {
+            while(value < current && !table[slot].compare_exchange_weak(current, value));
+            break;
+          }
+
+          slot = (slot + 1) & mask;
+        }
+      }
+    }
+  };
+
+  // Finds the first occurrence of every corner and counts first occurrences within each block
+  struct CornerResolve
+  {
+    size_t size;
+    const Corner* corners;
+    const boost::atomic< unsigned int >* table;
+    size_t mask;
+    unsigned int* representative;
+    size_t* count;
+
+    void operator()(const size_t _block) const
+    {
+      size_t end = std::min(size, (_block + 1) * block_size);
+      size_t total = 0;
+
+      for(size_t index = _block * block_size; index < end; ++index)
+      {
+        size_t slot = hash(corners[index]) & mask;
+        while(!(corners[table[slot]] == corners[index]))
+          slot = (slot + 1) & mask;
+
+        representative[index] = table[slot];
+        if(representative[index] == index)
+          total += 1;
+      }
+
+      count[_block] = total;
+    }
+  };
+
+  // Numbers first occurrences from the offset of each block
+  struct CornerNumber
+  {
+    size_t size;
+    const unsigned int* representative;
+    const size_t* offset;
+    unsigned int* identifier;
+
+    void operator()(const size_t _block) const
+    {
+      size_t end = std::min(size, (_block + 1) * block_size);
+      unsigned int next = static_cast< unsigned int >(offset[_block]);
+
+      for(size_t index = _block * block_size; index < end; ++index)
+      {
+        if(representative[index] == index)
+          identifier[index] = next++;
+      }
+    }
+  };
+
+  // Writes indices along with transformed attributes of every unique vertex
+  struct CornerEmit
+  {
+    const Corner* corners;
+    const unsigned int* representative;
+    const unsigned int* identifier;
+    const float* input_positions;
+    const float* input_texcoords;
+    const float* input_normals;
+    const Affine3f* transform;
+    const Eigen::Matrix3f* normal_transform;
+    float* positions;
+    float* texcoords;
+    uint32_t* normals;
+    unsigned int* indices;
+
+    void operator()(const tbb::blocked_range< size_t >& r) const
+    {
+      for(size_t index = r.begin(); index < r.end(); ++index)
+      {
+        unsigned int vertex = identifier[representative[index]];
+        indices[index] = vertex;
+
+        if(representative[index] != index)
+          continue;
+
+        const Corner& corner = corners[index];
+
+        Vector3f position = (*transform) * Vector3f(
+          input_positions[3 * corner.v + 0],
+          input_positions[3 * corner.v + 1],
+          input_positions[3 * corner.v + 2]
+          );
+
+        positions[3 * vertex + 0] = position.x();
+        positions[3 * vertex + 1] = position.y();
+        positions[3 * vertex + 2] = position.z();
+
+        if(texcoords != NULL)
+        {
+          texcoords[2 * vertex + 0] = (corner.vt < 0) ? 0.f : input_texcoords[2 * corner.vt + 0];
+          texcoords[2 * vertex + 1] = (corner.vt < 0) ? 0.f : input_texcoords[2 * corner.vt + 1];
+        }
+
+        if(normals != NULL)
+        {
+          Vector3f normal(0.f, 0.f, 0.f);
+          if(corner.vn >= 0)
+          {
+            normal = ((*normal_transform) * Vector3f(
+              input_normals[3 * corner.vn + 0],
+              input_normals[3 * corner.vn + 1],
+              input_normals[3 * corner.vn + 2]
+              )).normalized();
+          }
+
+          normals[vertex] = octahedralEncode(normal);
+        }
+      }
+    }
+  };
+}
+
+bool ObjReader::read(
+  const Affine3f& _transform,
+  std::vector< float >* _positions,
+  std::vector< uint32_t >* _normals,
+  std::vector< float >* _texcoords,
+  std::vector< unsigned int >* _indices
+  ) const
+{
+  boost::iostreams::mapped_file_source file;
+  try
+  {
+    file.open(m_filename);
+  }
+  catch(const std::exception&)
+  {
+    std::cerr << "error: " << "could not map " << m_filename << std::endl;
+    return false;
+  }
+
+  if(!file.is_open())
+    return false;
+
+  if(file.size() == 0)
+  {
+    _positions->clear();
+    _normals->clear();
+    _texcoords->clear();
+    _indices->clear();
+    return true;
+  }
+
+  const char* begin = file.data();
+  const char* end = begin + file.size();
+
+  // Split the file into chunks that start at the beginning of a line
+  std::vector< Chunk > chunks;
+  for(const char* p = begin; p < end;)
+  {
+    Chunk chunk;
+    chunk.begin = p;
+    chunk.end = nextLine(std::min(p + chunk_size, end - 1), end);
+    chunks.push_back(chunk);
+    p = chunk.end;
+  }
+
+  ChunkCount count;
+  count.chunks = &(chunks[0]);
+  tbb::parallel_for(size_t(0), chunks.size(), count);
+
+  // Exclusive prefix sum over the counts of every chunk
+  size_t total_positions = 0;
+  size_t total_texcoords = 0;
+  size_t total_normals = 0;
+  size_t total_triangles = 0;
+  for(size_t index = 0; index < chunks.size(); ++index)
+  {
+    std::swap(total_positions, chunks[index].positions);
+    std::swap(total_texcoords, chunks[index].texcoords);
+    std::swap(total_normals, chunks[index].normals);
+    std::swap(total_triangles, chunks[index].triangles);
+    total_positions += chunks[index].positions;
+    total_texcoords += chunks[index].texcoords;
+    total_normals += chunks[index].normals;
+    total_triangles += chunks[index].triangles;
+  }
+
+  size_t corner_count = 3 * total_triangles;
+  if(corner_count >= empty_slot)
+  {
+    std::cerr << "error: " << m_filename << " has too many triangles for 32 bit indices" << std::endl;
+    return false;
+  }
+
+  std::vector< float > input_positions(3 * total_positions + 1);
+  std::vector< float > input_texcoords(2 * total_texcoords + 1);
+  std::vector< float > input_normals(3 * total_normals + 1);
+  std::vector< Corner > corners(corner_count + 1);
+
+  ChunkParse parse;
+  parse.chunks = &(chunks[0]);
+  parse.total_positions = total_positions;
+  parse.total_texcoords = total_texcoords;
+  parse.total_normals = total_normals;
+  parse.positions = &(input_positions[0]);
+  parse.texcoords = &(input_texcoords[0]);
+  parse.normals = &(input_normals[0]);
+  parse.corners = &(corners[0]);
+  tbb::parallel_for(size_t(0), chunks.size(), parse);
+
+  file.close();
+
+  bool valid = true;
+  for(size_t index = 0; index < chunks.size(); ++index)
+    valid = valid && chunks[index].valid;
+
+  if(!valid)
+  {
+    std::cerr << "error: " << m_filename << " has faces with invalid indices" << std::endl;
+    return false;
+  }
+
+  if(corner_count == 0)
+  {
+    _positions->clear();
+    _normals->clear();
+    _texcoords->clear();
+    _indices->clear();
+    return true;
+  }
+
+  // Open addressing table at no more than half occupancy
+  size_t capacity = 1;
+  while(capacity < 2 * corner_count)
+    capacity <<= 1;
+
+  boost::scoped_array< boost::atomic< unsigned int > > table(new boost::atomic< unsigned int >[capacity]);
+  for(size_t slot = 0; slot < capacity; ++slot)
+    table[slot].store(empty_slot, boost::memory_order_relaxed);
+
+  CornerInsert insert;
+  insert.corners = &(corners[0]);
+  insert.table = table.get();
+  insert.mask = capacity - 1;
+  tbb::parallel_for(tbb::blocked_range< size_t >(0, corner_count), insert);
+
+  size_t block_count = (corner_count + block_size - 1) / block_size;
+  std::vector< unsigned int > representative(corner_count);
+  std::vector< unsigned int > identifier(corner_count);
+  std::vector< size_t > offset(block_count);
+
+  CornerResolve resolve;
+  resolve.size = corner_count;
+  resolve.corners = &(corners[0]);
+  resolve.table = table.get();
+  resolve.mask = capacity - 1;
+  resolve.representative = &(representative[0]);
+  resolve.count = &(offset[0]);
+  tbb::parallel_for(size_t(0), block_count, resolve);
+
+  table.reset();
+
+  size_t vertex_count = 0;
+  for(size_t block = 0; block < block_count; ++block)
+  {
+    std::swap(vertex_count, offset[block]);
+    vertex_count += offset[block];
+  }
+
+  CornerNumber number;
+  number.size = corner_count;
+  number.representative = &(representative[0]);
+  number.offset = &(offset[0]);
+  number.identifier = &(identifier[0]);
+  tbb::parallel_for(size_t(0), block_count, number);
+
+  // Embree reads the last position as four floats so one float of padding follows it
+  // Outputs are only replaced once the file is known to be valid
+  _positions->assign(3 * vertex_count + 1, 0.f);
+  _indices->assign(corner_count, 0);
+  _texcoords->assign((total_texcoords > 0) ? 2 * vertex_count : 0, 0.f);
+  _normals->assign((total_normals > 0) ? vertex_count : 0, 0);
+
+  Eigen::Matrix3f normal_transform = _transform.linear().inverse().transpose();
+
+  CornerEmit emit;
+  emit.corners = &(corners[0]);
+  emit.representative = &(representative[0]);
+  emit.identifier = &(identifier[0]);
+  emit.input_positions = &(input_positions[0]);
+  emit.input_texcoords = &(input_texcoords[0]);
+  emit.input_normals = &(input_normals[0]);
+  emit.transform = &_transform;
+  emit.normal_transform = &normal_transform;
+  emit.positions = &((*_positions)[0]);
+  emit.texcoords = (total_texcoords > 0) ? &((*_texcoords)[0]) : NULL;
+  emit.normals = (total_normals > 0) ? &((*_normals)[0]) : NULL;
+  emit.indices = &((*_indices)[0]);
+  tbb::parallel_for(tbb::blocked_range< size_t >(0, corner_count), emit);
+
+  return true;
+}
+
+MSC_NAMESPACE_END
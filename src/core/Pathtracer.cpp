@@ -1,7 +1,10 @@
 #include <fstream>
+#include <limits>
+#include <stdexcept>
 
 #include <tbb/tbb.h>
 #include <boost/thread.hpp>
+#include <boost/chrono.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -11,34 +14,222 @@
 #include <core/PinHoleCamera.h>
 #include <core/TentFilter.h>
 #include <core/BoxFilter.h>
+#include <core/GaussianFilter.h>
+#include <core/MitchellFilter.h>
+#include <core/LanczosFilter.h>
 #include <core/StratifiedSampler.h>
 #include <core/IndependentSampler.h>
 #include <core/GridSampler.h>
+#include <core/SobolSampler.h>
 #include <core/PolygonObject.h>
+#include <core/InstanceObject.h>
 #include <core/LambertShader.h>
 #include <core/NullShader.h>
 #include <core/QuadLight.h>
 #include <core/RaySort.h>
 #include <core/RayIntersect.h>
+#include <core/RayRequest.h>
+#include <core/RayPacket.h>
 #include <core/RayDecompress.h>
 #include <core/RayBoundingbox.h>
 #include <core/Convolve.h>
+#include <core/ContributionSort.h>
+#include <core/Accumulate.h>
+#include <core/Splat.h>
+#include <core/Tonemap.h>
 #include <core/Camera.h>
 #include <core/Integrator.h>
+#include <core/Prefetch.h>
+#include <core/ShadingKey.h>
 #include <core/Singleton.h>
+#include <core/TextureConverter.h>
+#include <core/SceneBundle.h>
 
 MSC_NAMESPACE_BEGIN
 
-void Pathtracer::construct(const std::string &_filename)
+namespace
 {
-  std::vector<YAML::Node> node_root = YAML::LoadAllFromFile(_filename);
+  // Memory held by embree, which only allocates acceleration structures since buffers are shared
+  boost::atomic< ssize_t > embree_memory(0);
+  boost::atomic< ssize_t > embree_peak(0);
 
-  YAML::Node node_setup = node_root[0];
-  YAML::Node node_scene = node_root[1];
+  bool memoryMonitor(const ssize_t _bytes, const bool)
+  {
+    ssize_t current = embree_memory.fetch_add(_bytes) + _bytes;
+    ssize_t peak = embree_peak.load();
+    while(current > peak && !embree_peak.compare_exchange_weak(peak, current));
+
+    return true;
+  }
+
+  // Scene flags for each build profile
+  int sceneFlags(const BvhProfile _profile)
+  {
+    switch(_profile)
+    {
+      case BVH_FAST: return RTC_SCENE_DYNAMIC | RTC_SCENE_COHERENT;
+      case BVH_QUALITY: return RTC_SCENE_STATIC | RTC_SCENE_COHERENT | RTC_SCENE_HIGH_QUALITY;
+      case BVH_COMPACT: return RTC_SCENE_STATIC | RTC_SCENE_COHERENT | RTC_SCENE_COMPACT;
+      case BVH_ROBUST: return RTC_SCENE_STATIC | RTC_SCENE_COHERENT | RTC_SCENE_ROBUST;
+      default: return RTC_SCENE_STATIC | RTC_SCENE_COHERENT;
+    }
+  }
+
+  // Packet traversal is only built when primary rays are traced in packets
+  int algorithmFlags(const Settings* _settings)
+  {
+    return _settings->primary_packets ? (RTC_INTERSECT1 | RTC_INTERSECT4) : RTC_INTERSECT1;
+  }
+
+  // Geometry that may be edited is refit rather than rebuilt
+  int geometryFlags(const Settings* _settings)
+  {
+    return _settings->scene_updates ? RTC_GEOMETRY_DEFORMABLE : RTC_GEOMETRY_STATIC;
+  }
+
+  // Adds polygon geometry to an embree scene without copying its buffers
+  unsigned int triangleMesh(RTCScene _scene, const PolygonObject& _object, const int _flags)
+  {
+    unsigned int geom_id = rtcNewTriangleMesh(
+      _scene,
+      _flags,
+      _object.triangles(),
+      _object.vertices()
+      );
+
+    rtcSetBuffer(
+      _scene,
+      geom_id,
+      RTC_VERTEX_BUFFER,
+      const_cast< float* >(_object.positions()),
+      0,
+      3 * sizeof(float)
+      );
+
+    rtcSetBuffer(
+      _scene,
+      geom_id,
+      RTC_INDEX_BUFFER,
+      const_cast< unsigned int* >(_object.indices()),
+      0,
+      3 * sizeof(unsigned int)
+      );
+
+    return geom_id;
+  }
+
+  // Adds light geometry that is only visible to camera and bsdf rays
+  unsigned int lightMesh(RTCScene _scene, QuadLight& _light, const int _flags)
+  {
+    unsigned int geom_id = rtcNewTriangleMesh(
+      _scene,
+      _flags,
+      _light.indices().size() / 3,
+      _light.positions().size() / 4
+      );
+
+    rtcSetBuffer(
+      _scene,
+      geom_id,
+      RTC_VERTEX_BUFFER,
+      &(_light.positions()[0]),
+      0,
+      4 * sizeof(float)
+      );
+
+    rtcSetBuffer(
+      _scene,
+      geom_id,
+      RTC_INDEX_BUFFER,
+      &(_light.indices()[0]),
+      0,
+      3 * sizeof(unsigned int)
+      );
+
+    rtcSetMask(_scene, geom_id, 0xF0000000);
+
+    return geom_id;
+  }
+
+  // Reads or maps every mesh in parallel
+  struct MeshLoading
+  {
+    std::vector< boost::shared_ptr< PolygonObject > >* meshes;
+    boost::shared_ptr< SceneBundle > bundle;
+
+    void operator()(const size_t _index) const
+    {
+      if(bundle)
+        (*meshes)[_index]->map(bundle, _index);
+      else
+        (*meshes)[_index]->construct();
+    }
+
+    void operator()() const
+    {
+      tbb::parallel_for(size_t(0), meshes->size(), *this);
+    }
+  };
+
+  // Converts untiled textures then resolves texture handles of every shader in parallel
+  struct TexturePreparation
+  {
+    Scene* scene;
+    TextureSystem texture_system;
+    std::string directory;
+    int tile_size;
+
+    void operator()(const size_t _index) const
+    {
+      scene->shaders[_index]->resolve(texture_system);
+    }
+
+    void operator()() const
+    {
+      // Untiled textures are converted before any handles are created for them
+      if(!directory.empty())
+      {
+        TextureConverter converter(directory, tile_size);
+        for(size_t index = 0; index < scene->shaders.size(); ++index)
+          scene->shaders[index]->preconvert(&converter);
+
+        converter.convert();
+      }
+
+      tbb::parallel_for(size_t(0), scene->shaders.size(), *this);
+    }
+  };
 
+  // Builds acceleration structures of instanced meshes in parallel
+  struct MeshCommit
+  {
+    Scene* scene;
+
+    void operator()(const size_t _index) const
+    {
+      rtcCommit(scene->rtc_meshes[_index]);
+    }
+  };
+}
+
+void Pathtracer::construct(const std::string &_filename)
+{
   boost::filesystem::path path(_filename);
   boost::filesystem::path dir = path.parent_path();
 
+  // Compiled bundles carry the original description and map their geometry instead
+  boost::shared_ptr< SceneBundle > bundle;
+  if(SceneBundle::identify(_filename))
+  {
+    bundle.reset(new SceneBundle(_filename));
+    dir = bundle->directory();
+  }
+
+  std::vector<YAML::Node> node_root = bundle ? YAML::LoadAll(bundle->document()) : YAML::LoadAllFromFile(_filename);
+
+  YAML::Node node_setup = node_root[0];
+  YAML::Node node_scene = node_root[1];
+
   SingletonString& scene_root = SingletonString::instance();
   scene_root.setData(dir.string());
 
@@ -49,41 +240,75 @@ void Pathtracer::construct(const std::string &_filename)
     image->height = 500;
     image->base = 8;
     image->iteration = 0;
+    image->film = FILM_SAMPLE;
 
     if(node_setup["image"])
       *image = node_setup["image"].as<Image>();
 
-    Sample temp_sample;
-    temp_sample.r = 0.f;
-    temp_sample.g = 0.f;
-    temp_sample.b = 0.f;
-    image->samples.resize(image->width * image->height * image->base * image->base, temp_sample);
-
     Pixel temp_pixel;
     temp_pixel.r = 0.f;
     temp_pixel.g = 0.f;
     temp_pixel.b = 0.f;
     image->pixels.resize(image->width * image->height, temp_pixel);
 
+    if(image->film == FILM_SAMPLE)
+    {
+      Sample temp_sample;
+      temp_sample.r = 0.f;
+      temp_sample.g = 0.f;
+      temp_sample.b = 0.f;
+      image->samples.resize(image->width * image->height * image->base * image->base, temp_sample);
+    }
+    else
+    {
+      image->splats.resize(image->width * image->height, temp_pixel);
+    }
+
     m_image.reset(image);
   }
 
   {
     Settings* settings = new Settings;
 
-    settings->min_depth = 2;
-    settings->max_depth = 100;
-    settings->threshold = 0.01f;
-    settings->bucket_size = 16;
-    settings->shading_size = 4096;
-    settings->bin_exponent = 25;
-
     if(node_setup["settings"])
       *settings = node_setup["settings"].as<Settings>();
 
     m_settings.reset(settings);
   }
 
+  {
+    m_texture_system = OpenImageIO::TextureSystem::create(false);
+    m_texture_system->attribute("max_memory_MB", m_settings->texture_cache);
+    m_texture_system->attribute("max_open_files", int(m_settings->texture_files));
+    m_texture_system->attribute("autotile", int(m_settings->texture_autotile));
+  }
+
+  {
+    m_image->variance.resize(m_image->width * m_image->height, 0.f);
+
+    m_image->tile_size = m_settings->bucket_size;
+    m_image->tile_columns = (m_image->width + m_image->tile_size - 1) / m_image->tile_size;
+    size_t tile_rows = (m_image->height + m_image->tile_size - 1) / m_image->tile_size;
+
+    for(size_t index_y = 0; index_y < tile_rows; ++index_y)
+    {
+      for(size_t index_x = 0; index_x < m_image->tile_columns; ++index_x)
+      {
+        Tile tile;
+        tile.x = index_x * m_image->tile_size;
+        tile.y = index_y * m_image->tile_size;
+        tile.width = std::min(m_image->tile_size, m_image->width - tile.x);
+        tile.height = std::min(m_image->tile_size, m_image->height - tile.y);
+        tile.iteration = 0;
+        tile.error = std::numeric_limits< float >::max();
+        tile.sampled = false;
+        tile.dirty = false;
+
+        m_image->tiles.push_back(tile);
+      }
+    }
+  }
+
   {
     ThinLensCamera* camera = new ThinLensCamera();
 
@@ -127,7 +352,30 @@ void Pathtracer::construct(const std::string &_filename)
         *box_filter = node_setup["filter"].as<BoxFilter>();
         m_filter.reset(box_filter);
       }
+
+      if(node_setup["filter"]["type"].as< std::string >() == "Gaussian")
+      {
+        GaussianFilter* gaussian_filter = new GaussianFilter();
+        *gaussian_filter = node_setup["filter"].as<GaussianFilter>();
+        m_filter.reset(gaussian_filter);
+      }
+
+      if(node_setup["filter"]["type"].as< std::string >() == "Mitchell")
+      {
+        MitchellFilter* mitchell_filter = new MitchellFilter();
+        *mitchell_filter = node_setup["filter"].as<MitchellFilter>();
+        m_filter.reset(mitchell_filter);
+      }
+
+      if(node_setup["filter"]["type"].as< std::string >() == "Lanczos")
+      {
+        LanczosFilter* lanczos_filter = new LanczosFilter();
+        *lanczos_filter = node_setup["filter"].as<LanczosFilter>();
+        m_filter.reset(lanczos_filter);
+      }
     }
+
+    m_filter_table.reset(new FilterTable(m_filter.get()));
   }
 
   {
@@ -157,12 +405,41 @@ void Pathtracer::construct(const std::string &_filename)
         *grid_sampler = node_setup["sampler"].as<GridSampler>();
         m_sampler.reset(grid_sampler);
       }
+
+      if(node_setup["sampler"]["type"].as< std::string >() == "Sobol")
+      {
+        SobolSampler* sobol_sampler = new SobolSampler();
+        *sobol_sampler = node_setup["sampler"].as<SobolSampler>();
+        m_sampler.reset(sobol_sampler);
+      }
     }
   }
 
+  // Paged geometry is mapped from a bundle and traced through proxies that are never edited
+  if(m_settings->geometry_cache > 0.f && !bundle)
+    throw std::runtime_error("the geometry cache needs a compiled scene bundle");
+
+  if(m_settings->geometry_cache > 0.f && m_settings->scene_updates)
+    throw std::runtime_error("scene updates are not supported while geometry is paged");
+
+  // Shared meshes are never edited so only the top level scene has to be dynamic
+  int mesh_flags = sceneFlags(m_settings->bvh_profile);
+  int scene_flags = m_settings->scene_updates ? (mesh_flags | RTC_SCENE_DYNAMIC) : mesh_flags;
+  int algorithm_flags = algorithmFlags(m_settings.get());
+  int geometry_flags = geometryFlags(m_settings.get());
+
   m_scene.reset(new Scene);
-  m_scene->rtc_scene = rtcNewScene(RTC_SCENE_STATIC | RTC_SCENE_COHERENT, RTC_INTERSECT1);
-  
+  m_scene->rtc_scene = rtcNewScene(scene_flags, algorithm_flags);
+
+  if(m_settings->geometry_cache > 0.f)
+    m_scene->geometry_cache.reset(new GeometryCache(bundle, m_settings->geometry_cache, mesh_flags));
+
+  // Entries are decoded in order while reading geometry is deferred so it can run in parallel
+  std::vector< boost::shared_ptr< PolygonObject > > meshes;
+  std::vector< int > object_meshes;
+  std::vector< size_t > object_pages;
+  std::vector< size_t > shared_pages;
+
   for(YAML::const_iterator scene_iterator = node_scene.begin(); scene_iterator != node_scene.end(); ++scene_iterator)
   {
     YAML::Node first = scene_iterator->first;
@@ -175,35 +452,44 @@ void Pathtracer::construct(const std::string &_filename)
         boost::shared_ptr< PolygonObject > polygon_object(new PolygonObject);
         *polygon_object = second.as<PolygonObject>();
 
-        size_t geom_id = rtcNewTriangleMesh(
-          m_scene->rtc_scene,
-          RTC_GEOMETRY_STATIC,
-          polygon_object->indices().size() / 3,
-          polygon_object->positions().size() / 4
-          );
-
-        rtcSetBuffer(
-          m_scene->rtc_scene,
-          geom_id,
-          RTC_VERTEX_BUFFER,
-          &(polygon_object->positions()[0]),
-          0,
-          4 * sizeof(float)
-          );
-
-        rtcSetBuffer(
-          m_scene->rtc_scene,
-          geom_id,
-          RTC_INDEX_BUFFER,
-          &(polygon_object->indices()[0]),
-          0,
-          3 * sizeof(unsigned int)
-          );
-
+        object_pages.push_back(meshes.size());
+        meshes.push_back(polygon_object);
+        object_meshes.push_back(-1);
         m_scene->objects.push_back(polygon_object);
       }
     }
 
+    if(first.as< std::string >() == "instance")
+    {
+      if(second["type"].as< std::string >() == "Polygon")
+      {
+        boost::shared_ptr< InstanceObject > instance_object(new InstanceObject);
+        *instance_object = second.as<InstanceObject>();
+
+        // Each file is read and built once then shared by all of its instances
+        std::map< std::string, size_t >::const_iterator cached = m_scene->mesh_files.find(instance_object->filename());
+        if(cached == m_scene->mesh_files.end())
+        {
+          boost::shared_ptr< PolygonObject > polygon_object(new PolygonObject);
+          polygon_object->filename(instance_object->filename());
+
+          cached = m_scene->mesh_files.insert(std::make_pair(instance_object->filename(), m_scene->meshes.size())).first;
+          shared_pages.push_back(meshes.size());
+          meshes.push_back(polygon_object);
+          m_scene->meshes.push_back(polygon_object);
+
+          if(!m_scene->geometry_cache)
+            m_scene->rtc_meshes.push_back(rtcNewScene(mesh_flags, algorithm_flags));
+        }
+
+        instance_object->mesh(m_scene->meshes[cached->second]);
+
+        object_pages.push_back(shared_pages[cached->second]);
+        object_meshes.push_back(cached->second);
+        m_scene->objects.push_back(instance_object);
+      }
+    }
+
     if(first.as< std::string >() == "shader")
     {
       if(second["type"].as< std::string >() == "Lambert")
@@ -215,7 +501,8 @@ void Pathtracer::construct(const std::string &_filename)
       }
     }
   }
-  
+
+  std::vector< boost::shared_ptr< QuadLight > > quad_lights;
   for(YAML::const_iterator light_iterator = node_scene.begin(); light_iterator != node_scene.end(); ++light_iterator)
   {
     YAML::Node first = light_iterator->first;
@@ -239,67 +526,445 @@ void Pathtracer::construct(const std::string &_filename)
         boost::shared_ptr< QuadLight > quad_light(new QuadLight);
         *quad_light = second.as<QuadLight>();
 
-        size_t geom_id = rtcNewTriangleMesh(
-          m_scene->rtc_scene,
-          RTC_GEOMETRY_STATIC,
-          quad_light->indices().size() / 3,
-          quad_light->positions().size() / 4
-          );
-
-        rtcSetBuffer(
-          m_scene->rtc_scene,
-          geom_id,
-          RTC_VERTEX_BUFFER,
-          &(quad_light->positions()[0]),
-          0,
-          4 * sizeof(float)
-          );
-
-        rtcSetBuffer(
-          m_scene->rtc_scene,
-          geom_id,
-          RTC_INDEX_BUFFER,
-          &(quad_light->indices()[0]),
-          0,
-          3 * sizeof(unsigned int)
-          );
-
-        rtcSetMask(m_scene->rtc_scene, geom_id, 0xF0000000);
-
+        quad_lights.push_back(quad_light);
         m_scene->lights.push_back(quad_light);
       }
     }
   }
 
+  if(bundle && bundle->meshes() != meshes.size())
+    throw std::runtime_error(_filename + " does not hold a mesh for every object in its scene");
+
+  // Meshes are read while textures are converted and opened
+  {
+    std::string directory = m_settings->texture_directory;
+    if(directory.empty())
+      directory = (dir / ".textures").string();
+
+    MeshLoading mesh_loading;
+    mesh_loading.meshes = &meshes;
+    mesh_loading.bundle = bundle;
+
+    TexturePreparation texture_preparation;
+    texture_preparation.scene = m_scene.get();
+    texture_preparation.texture_system = m_texture_system;
+    texture_preparation.directory = m_settings->texture_convert ? directory : std::string();
+    texture_preparation.tile_size = m_settings->texture_autotile ? int(m_settings->texture_autotile) : 64;
+
+    tbb::task_group group;
+    group.run(mesh_loading);
+    group.run(texture_preparation);
+    group.wait();
+  }
+
+  // Geometry ids must follow the order of the objects vector
+  if(m_scene->geometry_cache)
+  {
+    for(size_t index = 0; index < meshes.size(); ++index)
+      m_scene->geometry_cache->page(meshes[index], index);
+
+    for(size_t index = 0; index < object_pages.size(); ++index)
+    {
+      Affine3f transform = Affine3f::Identity();
+      if(object_meshes[index] >= 0)
+      {
+        const float* instance_transform = static_cast< InstanceObject* >(m_scene->objects[index].get())->transform();
+        for(size_t column = 0; column < 4; ++column)
+        {
+          for(size_t row = 0; row < 3; ++row)
+            transform.matrix()(row, column) = instance_transform[3 * column + row];
+        }
+      }
+
+      m_scene->geometry_cache->proxy(m_scene->rtc_scene, object_pages[index], transform);
+    }
+  }
+
+  for(size_t index = 0; index < m_scene->rtc_meshes.size(); ++index)
+    triangleMesh(m_scene->rtc_meshes[index], *m_scene->meshes[index], RTC_GEOMETRY_STATIC);
+
+  for(size_t index = 0; index < object_meshes.size() && !m_scene->geometry_cache; ++index)
+  {
+    if(object_meshes[index] < 0)
+    {
+      triangleMesh(m_scene->rtc_scene, *static_cast< PolygonObject* >(m_scene->objects[index].get()), geometry_flags);
+    }
+    else
+    {
+      unsigned int geom_id = rtcNewInstance(m_scene->rtc_scene, m_scene->rtc_meshes[object_meshes[index]]);
+      rtcSetTransform(
+        m_scene->rtc_scene,
+        geom_id,
+        RTC_MATRIX_COLUMN_MAJOR,
+        static_cast< InstanceObject* >(m_scene->objects[index].get())->transform()
+        );
+    }
+  }
+
+  for(size_t index = 0; index < quad_lights.size(); ++index)
+    lightMesh(m_scene->rtc_scene, *quad_lights[index], geometry_flags);
+
+  // The acceleration structures are built in the background until rays are first traced
+  m_commit_thread = boost::thread(&Pathtracer::sceneCommit, this);
+}
+
+void Pathtracer::sceneCommit()
+{
+  boost::chrono::high_resolution_clock::time_point timer_start = boost::chrono::high_resolution_clock::now();
+
+  MeshCommit commit;
+  commit.scene = m_scene.get();
+  tbb::parallel_for(size_t(0), m_scene->rtc_meshes.size(), commit);
+
   rtcCommit(m_scene->rtc_scene);
+
+  boost::chrono::high_resolution_clock::time_point timer_end = boost::chrono::high_resolution_clock::now();
+  boost::chrono::milliseconds build_time = boost::chrono::duration_cast< boost::chrono::milliseconds >(timer_end - timer_start);
+
+  std::cout << "\033[1;32mAcceleration structure built in " << build_time.count() << " ms using "
+    << embree_memory.load() / (1024 * 1024) << " MB with a peak of "
+    << embree_peak.load() / (1024 * 1024) << " MB.\033[0m" << std::endl;
+}
+
+void Pathtracer::sceneReady()
+{
+  if(m_commit_thread.joinable())
+    m_commit_thread.join();
+
+  // Edits are committed together once rays need to be traced again
+  if(m_commit_pending)
+  {
+    rtcCommit(m_scene->rtc_scene);
+    m_commit_pending = false;
+  }
+}
+
+void Pathtracer::sceneEditing()
+{
+  if(!m_settings->scene_updates)
+    throw std::runtime_error("scene updates must be enabled in the settings to edit the scene");
+
+  sceneReady();
+}
+
+void Pathtracer::sceneChanged()
+{
+  m_commit_pending = true;
+  clear();
+}
+
+ObjectInterface* Pathtracer::sceneObject(const int _object)
+{
+  if(_object < 0 || size_t(_object) >= m_scene->objects.size() || !m_scene->objects[_object])
+    throw std::runtime_error("object does not exist in the scene");
+
+  return m_scene->objects[_object].get();
+}
+
+void Pathtracer::sceneInsert(const unsigned int _geom_id, const boost::shared_ptr< ObjectInterface >& _object)
+{
+  // Embree reuses the ids of removed geometry
+  if(_geom_id >= m_scene->objects.size())
+    m_scene->objects.resize(_geom_id + 1);
+
+  m_scene->objects[_geom_id] = _object;
+}
+
+int Pathtracer::insert(const PolygonObject& _object)
+{
+  sceneEditing();
+
+  if(_object.shader() < 0 || size_t(_object.shader()) >= m_scene->shaders.size())
+    throw std::runtime_error("object refers to a shader that does not exist");
+
+  boost::shared_ptr< PolygonObject > polygon_object(new PolygonObject(_object));
+  polygon_object->construct();
+
+  unsigned int geom_id = triangleMesh(m_scene->rtc_scene, *polygon_object, geometryFlags(m_settings.get()));
+  sceneInsert(geom_id, polygon_object);
+
+  sceneChanged();
+  return geom_id;
+}
+
+int Pathtracer::insert(const InstanceObject& _instance)
+{
+  sceneEditing();
+
+  if(_instance.shader() < 0 || size_t(_instance.shader()) >= m_scene->shaders.size())
+    throw std::runtime_error("instance refers to a shader that does not exist");
+
+  boost::shared_ptr< InstanceObject > instance_object(new InstanceObject(_instance));
+
+  std::map< std::string, size_t >::const_iterator cached = m_scene->mesh_files.find(instance_object->filename());
+  if(cached == m_scene->mesh_files.end())
+  {
+    boost::shared_ptr< PolygonObject > polygon_object(new PolygonObject);
+    polygon_object->filename(instance_object->filename());
+    polygon_object->construct();
+
+    RTCScene rtc_mesh = rtcNewScene(sceneFlags(m_settings->bvh_profile), algorithmFlags(m_settings.get()));
+    triangleMesh(rtc_mesh, *polygon_object, RTC_GEOMETRY_STATIC);
+    rtcCommit(rtc_mesh);
+
+    cached = m_scene->mesh_files.insert(std::make_pair(instance_object->filename(), m_scene->meshes.size())).first;
+    m_scene->meshes.push_back(polygon_object);
+    m_scene->rtc_meshes.push_back(rtc_mesh);
+  }
+
+  instance_object->mesh(m_scene->meshes[cached->second]);
+
+  unsigned int geom_id = rtcNewInstance(m_scene->rtc_scene, m_scene->rtc_meshes[cached->second]);
+  rtcSetTransform(m_scene->rtc_scene, geom_id, RTC_MATRIX_COLUMN_MAJOR, instance_object->transform());
+  sceneInsert(geom_id, instance_object);
+
+  sceneChanged();
+  return geom_id;
+}
+
+int Pathtracer::insert(const QuadLight& _light)
+{
+  sceneEditing();
+
+  // Shaders left behind by removed lights are reused so that repeated edits do not grow the list
+  int shader_id = m_scene->shaders.size();
+  if(!m_scene->free_shaders.empty())
+  {
+    shader_id = m_scene->free_shaders.back();
+    m_scene->free_shaders.pop_back();
+  }
+  else
+  {
+    boost::shared_ptr< NullShader > null_shader(new NullShader);
+    m_scene->shaders.push_back(null_shader);
+  }
+
+  int light_id = m_scene->lights.size();
+  m_scene->shaders_to_lights.insert(std::make_pair(shader_id, light_id));
+
+  boost::shared_ptr< QuadLight > quad_light(new QuadLight(_light));
+  quad_light->construct();
+  m_scene->lights.push_back(quad_light);
+
+  boost::shared_ptr< PolygonObject > polygon_object(new PolygonObject);
+  polygon_object->shader(shader_id);
+
+  unsigned int geom_id = lightMesh(m_scene->rtc_scene, *quad_light, geometryFlags(m_settings.get()));
+  sceneInsert(geom_id, polygon_object);
+
+  sceneChanged();
+  return geom_id;
+}
+
+void Pathtracer::transform(const int _object, const Vector3f& _translation, const Vector3f& _rotation, const Vector3f& _scale)
+{
+  sceneEditing();
+
+  ObjectInterface* object = sceneObject(_object);
+
+  if(m_scene->shaders_to_lights.count(object->shader()))
+    throw std::runtime_error("lights cannot be transformed, remove and insert them instead");
+
+  if(InstanceObject* instance_object = dynamic_cast< InstanceObject* >(object))
+  {
+    instance_object->translation(_translation);
+    instance_object->rotation(_rotation);
+    instance_object->scale(_scale);
+    instance_object->construct();
+
+    rtcSetTransform(m_scene->rtc_scene, _object, RTC_MATRIX_COLUMN_MAJOR, instance_object->transform());
+  }
+  else if(PolygonObject* polygon_object = dynamic_cast< PolygonObject* >(object))
+  {
+    polygon_object->transform(_translation, _rotation, _scale);
+
+    // Mapped geometry moves into memory when it is first transformed
+    rtcSetBuffer(
+      m_scene->rtc_scene,
+      _object,
+      RTC_VERTEX_BUFFER,
+      const_cast< float* >(polygon_object->positions()),
+      0,
+      3 * sizeof(float)
+      );
+
+    rtcSetBuffer(
+      m_scene->rtc_scene,
+      _object,
+      RTC_INDEX_BUFFER,
+      const_cast< unsigned int* >(polygon_object->indices()),
+      0,
+      3 * sizeof(unsigned int)
+      );
+  }
+
+  rtcUpdate(m_scene->rtc_scene, _object);
+  sceneChanged();
+}
+
+void Pathtracer::remove(const int _object)
+{
+  sceneEditing();
+
+  ObjectInterface* object = sceneObject(_object);
+
+  // Next event estimation samples the lights so at least one must remain
+  std::map< int, int >::iterator light = m_scene->shaders_to_lights.find(object->shader());
+  if(light != m_scene->shaders_to_lights.end() && m_scene->lights.size() == 1)
+    throw std::runtime_error("the last light cannot be removed from the scene");
+
+  rtcDeleteGeometry(m_scene->rtc_scene, _object);
+
+  // Lights are removed along with the geometry standing in for them
+  if(light != m_scene->shaders_to_lights.end())
+  {
+    int light_id = light->second;
+    m_scene->lights.erase(m_scene->lights.begin() + light_id);
+    m_scene->free_shaders.push_back(light->first);
+    m_scene->shaders_to_lights.erase(light);
+
+    for(std::map< int, int >::iterator iterator = m_scene->shaders_to_lights.begin(); iterator != m_scene->shaders_to_lights.end(); ++iterator)
+    {
+      if(iterator->second > light_id)
+        iterator->second -= 1;
+    }
+  }
+
+  m_scene->objects[_object].reset();
+
+  sceneChanged();
 }
 
 void Pathtracer::cameraSampling()
 {
-  // Create primary rays from camera
-  tbb::parallel_for(
-    tbb::blocked_range2d< size_t >(0, m_image->width, m_settings->bucket_size, 0, m_image->height, m_settings->bucket_size),
-    Camera(
-      m_camera.get(),
-      m_sampler.get(),
-      m_image.get(),
-      m_bins.get(),
-      &m_batch_queue,
-      &m_thread_random_generator
-      ),
-    tbb::simple_partitioner()
-    );
+  // Select tiles that have not converged once enough iterations have been resolved
+  bool adaptive = (m_settings->adaptive_threshold > 0.f && m_image->iteration >= m_settings->min_iterations);
+  size_t count = m_image->base * m_image->base;
+
+  for(size_t index = 0; index < m_image->tiles.size(); ++index)
+  {
+    Tile& tile = m_image->tiles[index];
+    tile.sampled = !adaptive || tile.error > m_settings->adaptive_threshold;
+
+    if(tile.sampled)
+      m_sample_count += tile.width * tile.height * count;
+  }
+
+  // Primary rays are created on demand as tracing makes room for them
+  m_camera_tile = 0;
+  m_camera_offsets.resize(m_image->tiles.size());
+}
+
+void Pathtracer::cameraStreaming(RayUncompressed* _buffer, const size_t _capacity)
+{
+  size_t count = m_image->base * m_image->base;
+
+  while(m_camera_tile < m_image->tiles.size())
+  {
+    size_t pending = m_bins->pending();
+    size_t begin = m_camera_tile;
+    size_t size = 0;
+    bool packets = m_settings->primary_packets;
+
+    // Always emit when nothing is in flight so that a budget below one tile still makes progress
+    while(m_camera_tile < m_image->tiles.size())
+    {
+      const Tile& tile = m_image->tiles[m_camera_tile];
+      size_t rays = tile.sampled ? tile.width * tile.height * count : 0;
+
+      if(m_settings->ray_budget > 0 && pending > 0 && pending + rays > m_settings->ray_budget)
+        break;
+
+      if(packets && size + rays > _capacity)
+      {
+        if(size > 0)
+          break;
+
+        // A tile that alone exceeds the batch buffer is written to the bins instead
+        packets = false;
+        ++m_camera_tile;
+        break;
+      }
+
+      m_camera_offsets[m_camera_tile] = size;
+      pending += rays;
+      size += rays;
+      ++m_camera_tile;
+    }
+
+    if(begin == m_camera_tile)
+      return;
+
+    if(!packets)
+    {
+      // Create primary rays from camera
+      tbb::parallel_for(
+        tbb::blocked_range< size_t >(begin, m_camera_tile, 1),
+        Camera(
+          m_camera.get(),
+          m_sampler.get(),
+          m_image.get(),
+          m_bins.get(),
+          &m_batch_queue
+          ),
+        tbb::simple_partitioner()
+        );
+
+      return;
+    }
+
+    // Coherent primary rays are traced and shaded in place so only secondary rays reach the bins
+    tbb::parallel_for(
+      tbb::blocked_range< size_t >(begin, m_camera_tile, 1),
+      Camera(
+        m_camera.get(),
+        m_sampler.get(),
+        m_image.get(),
+        m_bins.get(),
+        &m_batch_queue,
+        _buffer,
+        &(m_camera_offsets[0])
+        ),
+      tbb::simple_partitioner()
+      );
+
+    BatchItem batch_info;
+    batch_info.size = size;
+
+    // Paged geometry is traced one ray at a time across its proxies
+    if(m_scene->geometry_cache)
+    {
+      sceneTraversal(batch_info, _buffer);
+    }
+    else
+    {
+      sceneReady();
+      tbb::parallel_for(tbb::blocked_range< size_t >(0, size, 64), RayPacket(m_scene.get(), _buffer));
+    }
+
+    hitPointSorting(batch_info, _buffer);
+
+    surfaceShading(batch_info, _buffer);
+
+    sampleAccumulation();
+  }
 }
 
-bool Pathtracer::batchLoading(BatchItem* batch_info)
+bool Pathtracer::batchLoading(BatchItem* batch_info, RayUncompressed* batch_uncompressed, const size_t bin_size)
 {
+  // Top up with primary rays while the rays in flight are within budget
+  cameraStreaming(batch_uncompressed, bin_size);
+
   // Query and load from batch queue 
   if(!m_batch_queue.try_pop(*batch_info))
   {
     m_bins->flush(&m_batch_queue);
-    return m_batch_queue.try_pop(*batch_info);
+
+    if(!m_batch_queue.try_pop(*batch_info))
+      return false;
   }
 
+  m_bins->release(batch_info->size);
   return true;
 }
 
@@ -328,6 +993,15 @@ void Pathtracer::raySorting(const BatchItem& batch_info, RayUncompressed* batch_
 
 void Pathtracer::sceneTraversal(const BatchItem& batch_info, RayUncompressed* batch_uncompressed)
 {
+  sceneReady();
+
+  // Build paged geometry that the batch reaches before any of it is traced
+  if(m_scene->geometry_cache)
+  {
+    tbb::parallel_for(tbb::blocked_range< size_t >(0, batch_info.size, 128), RayRequest(m_scene.get(), batch_uncompressed));
+    m_scene->geometry_cache->update();
+  }
+
   // Traverse scene with sorted rays
   tbb::parallel_for(tbb::blocked_range< size_t >(0, batch_info.size, 128), RayIntersect(m_scene.get(), batch_uncompressed));
 }
@@ -335,34 +1009,170 @@ void Pathtracer::sceneTraversal(const BatchItem& batch_info, RayUncompressed* ba
 void Pathtracer::hitPointSorting(const BatchItem& batch_info, RayUncompressed* batch_uncompressed)
 {
   // Sort hit points according to geometry and primitives
-  tbb::parallel_sort(&batch_uncompressed[0], &batch_uncompressed[batch_info.size], CompareHit());
+  if(!m_settings->texture_sort)
+  {
+    tbb::parallel_sort(&batch_uncompressed[0], &batch_uncompressed[batch_info.size], CompareHit());
+    return;
+  }
+
+  // Sort hit points according to geometry then texture tiles before primitives
+  tbb::parallel_for(tbb::blocked_range< size_t >(0, batch_info.size, 1024), ShadingKey(m_scene.get(), batch_uncompressed));
+  tbb::parallel_sort(&batch_uncompressed[0], &batch_uncompressed[batch_info.size], CompareShading());
 }
 
 void Pathtracer::surfaceShading(const BatchItem& batch_info, RayUncompressed* batch_uncompressed)
 {
+  // Fault texture tiles for upcoming ranges into the cache while earlier ranges are shading
+  if(m_prefetch)
+    m_prefetch->begin(batch_uncompressed, batch_info.size);
+
   // Intergrate shading and create secondary rays
   tbb::parallel_for(
     RangeGeom< RayUncompressed* >(0, batch_info.size, m_settings->shading_size, batch_uncompressed),
     Integrator(
       m_scene.get(),
-      m_image.get(),
       m_settings.get(),
       m_bins.get(),
       &m_batch_queue,
-      &m_thread_texture_system,
-      &m_thread_random_generator,
-      batch_uncompressed
+      m_texture_system,
+      &m_thread_texture_info,
+      &m_thread_contributions,
+      &m_thread_histogram,
+      batch_uncompressed,
+      m_image->base * m_image->base,
+      m_image->iteration,
+      m_prefetch.get()
       ),
     tbb::simple_partitioner()
     );
+
+  if(m_prefetch)
+    m_prefetch->end();
+}
+
+void Pathtracer::sampleAccumulation()
+{
+  // Gather thread local contributions
+  size_t size = 0;
+  for(LocalContributions::iterator it = m_thread_contributions.begin(); it != m_thread_contributions.end(); ++it)
+    size += it->size();
+
+  if(size == 0)
+    return;
+
+  m_contributions.resize(size);
+  m_contributions_temp.resize(size);
+
+  size_t offset = 0;
+  for(LocalContributions::iterator it = m_thread_contributions.begin(); it != m_thread_contributions.end(); ++it)
+  {
+    std::copy(it->begin(), it->end(), m_contributions.begin() + offset);
+    offset += it->size();
+    it->clear();
+  }
+
+  // Sort according to sample and reduce into film
+  ContributionSort(size, &(m_contributions[0]), &(m_contributions_temp[0]))();
+
+  if(m_image->film == FILM_SAMPLE)
+  {
+    tbb::parallel_for(tbb::blocked_range< size_t >(0, size, 4096), Accumulate(size, &(m_contributions[0]), m_image.get()));
+  }
+  else
+  {
+    // Alternate between even and odd stripes of rows so that footprints never overlap
+    size_t stripe = std::max(m_settings->bucket_size, size_t(2 * m_filter_table->margin()));
+    size_t stripe_count = (m_image->height + stripe - 1) / stripe;
+
+    for(size_t phase = 0; phase < 2; ++phase)
+    {
+      tbb::parallel_for(
+        tbb::blocked_range< size_t >(0, (stripe_count + 1 - phase) / 2, 1),
+        Splat(m_filter_table.get(), m_sampler.get(), m_image.get(), size, &(m_contributions[0]), stripe, phase)
+        );
+    }
+  }
+}
+
+void Pathtracer::textureStatistics()
+{
+  long long find_tile_calls = 0;
+  long long bytes_read = 0;
+  long long cache_memory_used = 0;
+  int microcache_misses = 0;
+  int cache_misses = 0;
+
+  m_texture_system->getattribute("stat:find_tile_calls", OpenImageIO::TypeDesc::INT64, &find_tile_calls);
+  m_texture_system->getattribute("stat:bytes_read", OpenImageIO::TypeDesc::INT64, &bytes_read);
+  m_texture_system->getattribute("stat:cache_memory_used", OpenImageIO::TypeDesc::INT64, &cache_memory_used);
+  m_texture_system->getattribute("stat:find_tile_microcache_misses", microcache_misses);
+  m_texture_system->getattribute("stat:find_tile_cache_misses", cache_misses);
+
+  if(find_tile_calls == 0)
+    return;
+
+  float microcache_hit_rate = 100.f * (1.f - float(microcache_misses) / float(find_tile_calls));
+  float cache_hit_rate = 100.f * (1.f - float(cache_misses) / float(find_tile_calls));
+
+  std::cout << "\033[1;32mTexture cache hit rate is " << cache_hit_rate << "% with "
+    << microcache_hit_rate << "% in the microcache.\033[0m" << std::endl;
+  std::cout << "\033[1;32mTexture cache uses " << cache_memory_used / (1024 * 1024) << " MB after reading "
+    << bytes_read / (1024 * 1024) << " MB from disk.\033[0m" << std::endl;
+}
+
+void Pathtracer::geometryStatistics()
+{
+  if(!m_scene->geometry_cache)
+    return;
+
+  std::cout << "\033[1;32mGeometry cache holds " << m_scene->geometry_cache->resident() / (1024 * 1024)
+    << " MB, peaking at " << m_scene->geometry_cache->peak() / (1024 * 1024)
+    << " MB, after building " << m_scene->geometry_cache->builds() << " meshes and releasing "
+    << m_scene->geometry_cache->evictions() << ".\033[0m" << std::endl;
+}
+
+void Pathtracer::pathStatistics()
+{
+  // Gather thread local depth histograms
+  std::vector< size_t > histogram(m_settings->max_depth + 1, 0);
+  for(LocalDepthHistogram::iterator it = m_thread_histogram.begin(); it != m_thread_histogram.end(); ++it)
+  {
+    for(size_t depth = 0; depth < it->size(); ++depth)
+      histogram[depth] += (*it)[depth];
+
+    std::fill(it->begin(), it->end(), 0);
+  }
+
+  size_t paths = 0;
+  size_t depth_sum = 0;
+  size_t max_depth = 0;
+  for(size_t depth = 0; depth < histogram.size(); ++depth)
+  {
+    paths += histogram[depth];
+    depth_sum += histogram[depth] * depth;
+
+    if(histogram[depth] > 0)
+      max_depth = depth;
+  }
+
+  if(paths == 0)
+    return;
+
+  std::cout << "\033[1;32mPaths terminated at a mean depth of " << float(depth_sum) / float(paths)
+    << " with a maximum of " << max_depth << ".\033[0m" << std::endl;
+
+  for(size_t depth = 0; depth <= max_depth; ++depth)
+    std::cout << "\033[1;32m  depth " << depth << ": " << histogram[depth] << " paths\033[0m" << std::endl;
 }
 
 void Pathtracer::imageConvolution()
 {
-  // Convolve iamge using filter interface
+  // Convolve sampled tiles using filter interface
+  boost::mutex::scoped_lock lock(m_image_mutex);
+
   tbb::parallel_for(
-    tbb::blocked_range2d< size_t >(0, m_image->width, m_settings->bucket_size, 0, m_image->height, m_settings->bucket_size),
-    Convolve(m_filter.get(), m_image.get())
+    tbb::blocked_range< size_t >(0, m_image->tiles.size(), 1),
+    Convolve(m_filter_table.get(), m_sampler.get(), m_image.get())
     );
 }
 
@@ -371,23 +1181,35 @@ Pathtracer::Pathtracer(const std::string &_filename)
   _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
   _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
   rtcInit(NULL);
-
-  LocalTextureSystem m_thread_texture_system(nullTextureSystem);
+  rtcSetMemoryMonitorFunction(memoryMonitor);
 
   construct(_filename);
+
+  if(m_settings->prefetch_threads > 0)
+    m_prefetch.reset(new Prefetch(m_scene.get(), m_settings.get(), m_texture_system));
+
   m_terminate = false;
+  m_commit_pending = false;
+  m_sample_count = 0;
+  m_camera_tile = 0;
 }
 
 Pathtracer::~Pathtracer()
 {
-  for(LocalTextureSystem::const_iterator it = m_thread_texture_system.begin(); it != m_thread_texture_system.end();  ++it)
-    OpenImageIO::TextureSystem::destroy(*it, false);
+  m_prefetch.reset();
+  OpenImageIO::TextureSystem::destroy(m_texture_system, false);
 
   BatchItem batch_info;
   while(m_batch_queue.try_pop(batch_info))
     boost::filesystem::remove(batch_info.filename);
 
+  if(m_commit_thread.joinable())
+    m_commit_thread.join();
+
+  m_scene->geometry_cache.reset();
   rtcDeleteScene(m_scene->rtc_scene);
+  for(size_t index = 0; index < m_scene->rtc_meshes.size(); ++index)
+    rtcDeleteScene(m_scene->rtc_meshes[index]);
   rtcExit();
 }
 
@@ -399,17 +1221,71 @@ void Pathtracer::image(float** _pixels, int* _width, int* _height)
   *_height = m_image->height;
 }
 
+void Pathtracer::preview(unsigned char* _image, std::vector< Tile >* _tiles)
+{
+  boost::mutex::scoped_lock lock(m_image_mutex);
+
+  std::vector< size_t > dirty;
+  for(size_t index = 0; index < m_image->tiles.size(); ++index)
+  {
+    if(m_image->tiles[index].dirty)
+    {
+      m_image->tiles[index].dirty = false;
+      dirty.push_back(index);
+      _tiles->push_back(m_image->tiles[index]);
+    }
+  }
+
+  if(dirty.size() > 0)
+    tbb::parallel_for(tbb::blocked_range< size_t >(0, dirty.size(), 1), Tonemap(m_image.get(), &(dirty[0]), _image));
+}
+
 void Pathtracer::clear()
 {
+  boost::mutex::scoped_lock lock(m_image_mutex);
+
   size_t pixel_count = m_image->width * m_image->height;
   for(size_t i = 0; i < pixel_count; ++i)
   {
     m_image->pixels[i].r = 0.f;
     m_image->pixels[i].g = 0.f;
     m_image->pixels[i].b = 0.f;
+    m_image->variance[i] = 0.f;
+  }
+
+  for(size_t i = 0; i < m_image->tiles.size(); ++i)
+  {
+    m_image->tiles[i].iteration = 0;
+    m_image->tiles[i].error = std::numeric_limits< float >::max();
+    m_image->tiles[i].dirty = true;
   }
 
   m_image->iteration = 0;
+  m_sample_count = 0;
+}
+
+bool Pathtracer::adaptive()
+{
+  return m_settings->adaptive_threshold > 0.f || m_settings->sample_budget > 0;
+}
+
+bool Pathtracer::converged()
+{
+  if(m_settings->sample_budget > 0 && m_sample_count >= m_settings->sample_budget)
+    return true;
+
+  if(m_settings->adaptive_threshold > 0.f && m_image->iteration >= m_settings->min_iterations)
+  {
+    for(size_t index = 0; index < m_image->tiles.size(); ++index)
+    {
+      if(m_image->tiles[index].error > m_settings->adaptive_threshold)
+        return false;
+    }
+
+    return true;
+  }
+
+  return false;
 }
 
 bool Pathtracer::active()
@@ -430,6 +1306,15 @@ int Pathtracer::process()
   RayCompressed* batch_compressed = new RayCompressed[bin_size];
   RayUncompressed* batch_uncompressed = new RayUncompressed[bin_size];
 
+  if(m_image->film == FILM_SPLAT)
+  {
+    Pixel temp_pixel;
+    temp_pixel.r = 0.f;
+    temp_pixel.g = 0.f;
+    temp_pixel.b = 0.f;
+    std::fill(m_image->splats.begin(), m_image->splats.end(), temp_pixel);
+  }
+
   cameraSampling();
 
   std::cout << "\033[1;32mSample count is " << m_image->base * m_image->base << " samples per pixel.\033[0m" << std::endl;
@@ -438,10 +1323,10 @@ int Pathtracer::process()
   std::cout << "\033[1;32mCurrent queue holds " << m_batch_queue.unsafe_size() << " batches.\033[0m" << std::endl;
 
   BatchItem pre_batch_info;
-  bool pre_batch_found = batchLoading(&pre_batch_info);
+  bool pre_batch_found = batchLoading(&pre_batch_info, batch_uncompressed, bin_size);
 
   BatchItem post_batch_info;
-  bool post_batch_found = batchLoading(&post_batch_info);
+  bool post_batch_found = batchLoading(&post_batch_info, batch_uncompressed, bin_size);
 
   if(pre_batch_found)
     fileLoading(pre_batch_info, batch_compressed);
@@ -464,6 +1349,8 @@ int Pathtracer::process()
 
     surfaceShading(pre_batch_info, batch_uncompressed);
 
+    sampleAccumulation();
+
     if(post_batch_found)
       loading_thread.join();
 
@@ -471,7 +1358,7 @@ int Pathtracer::process()
 
     std::swap(pre_batch_found, post_batch_found);
     std::swap(pre_batch_info, post_batch_info);
-    post_batch_found = batchLoading(&post_batch_info);
+    post_batch_found = batchLoading(&post_batch_info, batch_uncompressed, bin_size);
   }
 
   delete[] batch_uncompressed;
@@ -487,6 +1374,9 @@ int Pathtracer::process()
     return 0;
 
   imageConvolution();
+  textureStatistics();
+  geometryStatistics();
+  pathStatistics();
 
   m_image->iteration += 1;
   return m_image->iteration;
@@ -13,7 +13,7 @@ void PinHoleCamera::construct()
   m_normal = (m_transform.linear().inverse().transpose() * Vector3f::UnitX()).normalized();
 }
 
-void PinHoleCamera::sample(const int _count, float* _positions, RandomGenerator* _random, RayCompressed* _ouput) const
+void PinHoleCamera::sample(const int _count, float* _positions, float* _lens, RayCompressed* _ouput) const
 {
   Vector3f nodal_point = m_translation + (m_normal * m_focal_length);
 
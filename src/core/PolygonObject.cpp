@@ -1,45 +1,140 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
 #include <core/PolygonObject.h>
+#include <core/ObjReader.h>
 
 MSC_NAMESPACE_BEGIN
 
+PolygonObject::PolygonObject(const PolygonObject& _other)
+  : m_position_data(NULL)
+  , m_normal_data(NULL)
+  , m_texcoord_data(NULL)
+  , m_texcoord_unit_data(NULL)
+  , m_index_data(NULL)
+  , m_vertex_count(0)
+  , m_triangle_count(0)
+{
+  *this = _other;
+}
+
+PolygonObject& PolygonObject::operator=(const PolygonObject& _other)
+{
+  if(this == &_other)
+    return *this;
+
+  m_filename = _other.m_filename;
+  m_translation = _other.m_translation;
+  m_rotation = _other.m_rotation;
+  m_scale = _other.m_scale;
+  m_shader = _other.m_shader;
+
+  m_positions = _other.m_positions;
+  m_normals = _other.m_normals;
+  m_texcoords = _other.m_texcoords;
+  m_texcoord_units = _other.m_texcoord_units;
+  m_indices = _other.m_indices;
+  m_source_positions = _other.m_source_positions;
+  m_source_normals = _other.m_source_normals;
+  m_source_placement = _other.m_source_placement;
+
+  m_texcoord_lower = _other.m_texcoord_lower;
+  m_texcoord_extent = _other.m_texcoord_extent;
+  m_bundle = _other.m_bundle;
+
+  // Mapped geometry is shared with the bundle, owned geometry has to point at the new copies
+  if(m_bundle)
+  {
+    m_position_data = _other.m_position_data;
+    m_normal_data = _other.m_normal_data;
+    m_texcoord_data = _other.m_texcoord_data;
+    m_texcoord_unit_data = _other.m_texcoord_unit_data;
+    m_index_data = _other.m_index_data;
+    m_vertex_count = _other.m_vertex_count;
+    m_triangle_count = _other.m_triangle_count;
+  }
+  else
+  {
+    view();
+  }
+
+  return *this;
+}
+
 void PolygonObject::construct()
 {
-  tinyobj::shape_t shape;
-  std::string err = tinyobj::LoadObj(shape, m_filename.c_str());
+  ObjReader reader(m_filename);
+  if(!reader.read(placement(), &m_positions, &m_normals, &m_texcoords, &m_indices))
+    throw std::runtime_error("could not read geometry from " + m_filename);
 
-  // if(!err.empty())
-  //   std::cout << err << std::endl;
+  compact();
+  view();
+}
 
-  m_normals.swap(shape.mesh.normals);
-  m_texcoords.swap(shape.mesh.texcoords);
-  m_indices.swap(shape.mesh.indices);
+void PolygonObject::map(const boost::shared_ptr< SceneBundle >& _bundle, const size_t _mesh)
+{
+  const BundleMesh& mesh = _bundle->mesh(_mesh);
 
-  Affine3f transform = Affine3f::Identity()
-   * Eigen::Translation3f(m_translation)
-   * Eigen::AngleAxisf(m_rotation.x() * M_PI_180, Vector3f::UnitX())
-   * Eigen::AngleAxisf(m_rotation.y() * M_PI_180, Vector3f::UnitY())
-   * Eigen::AngleAxisf(m_rotation.z() * M_PI_180, Vector3f::UnitZ())
-   * Eigen::AlignedScaling3f(m_scale);
+  m_position_data = reinterpret_cast< const float* >(_bundle->data(mesh.positions_offset));
+  m_normal_data = mesh.normals_size ? reinterpret_cast< const uint32_t* >(_bundle->data(mesh.normals_offset)) : NULL;
+  m_texcoord_data = NULL;
+  m_texcoord_unit_data = NULL;
+  m_index_data = reinterpret_cast< const unsigned int* >(_bundle->data(mesh.indices_offset));
+
+  if(mesh.texcoords_size && mesh.texcoord_bits == 16)
+    m_texcoord_unit_data = reinterpret_cast< const uint16_t* >(_bundle->data(mesh.texcoords_offset));
+  else if(mesh.texcoords_size)
+    m_texcoord_data = reinterpret_cast< const float* >(_bundle->data(mesh.texcoords_offset));
+
+  m_texcoord_lower = Vector2f(mesh.texcoord_lower[0], mesh.texcoord_lower[1]);
+  m_texcoord_extent = Vector2f(mesh.texcoord_extent[0], mesh.texcoord_extent[1]);
+  m_vertex_count = mesh.positions_size / 3;
+  m_triangle_count = mesh.indices_size / 3;
+  m_bundle = _bundle;
+}
 
-  Vector3fMap mapped_normal(NULL);
-  for(size_t i = 0; i < m_normals.size() / 3; ++i)
+void PolygonObject::transform(const Vector3f& _translation, const Vector3f& _rotation, const Vector3f& _scale)
+{
+  // Mapped geometry is read only so it is brought into memory before being changed
+  if(m_bundle)
   {
-    new (&mapped_normal) Vector3fMap((float*) &(m_normals[3 * i + 0]));
-    mapped_normal = (transform.linear().inverse().transpose() * mapped_normal).normalized();
+    m_positions.assign(m_position_data, m_position_data + (m_vertex_count ? 3 * m_vertex_count + 1 : 0));
+    m_indices.assign(m_index_data, m_index_data + 3 * m_triangle_count);
+    if(m_normal_data != NULL)
+      m_normals.assign(m_normal_data, m_normal_data + m_vertex_count);
+    if(m_texcoord_data != NULL)
+      m_texcoords.assign(m_texcoord_data, m_texcoord_data + 2 * m_vertex_count);
+    if(m_texcoord_unit_data != NULL)
+      m_texcoord_units.assign(m_texcoord_unit_data, m_texcoord_unit_data + 2 * m_vertex_count);
+
+    view();
+    m_bundle.reset();
   }
 
-  Vector3fMap mapped_position(NULL);
-  m_positions.resize((shape.mesh.positions.size() / 3) * 4);
-  for(size_t i = 0; i < shape.mesh.positions.size() / 3; ++i)
+  // Geometry is kept as it was first placed and always transformed from there
+  if(m_source_positions.empty())
   {
-    m_positions[4 * i + 0] = shape.mesh.positions[3 * i + 0];
-    m_positions[4 * i + 1] = shape.mesh.positions[3 * i + 1];
-    m_positions[4 * i + 2] = shape.mesh.positions[3 * i + 2];
-    m_positions[4 * i + 3] = 0.f;
+    m_source_positions = m_positions;
+    m_source_normals = m_normals;
+    m_source_placement = placement();
+  }
+
+  m_translation = _translation;
+  m_rotation = _rotation;
+  m_scale = _scale;
 
-    new (&mapped_position) Vector3fMap((float*) &(m_positions[4 * i + 0]));
-    mapped_position = transform * mapped_position;
+  Affine3f change = placement() * m_source_placement.inverse();
+
+  for(size_t i = 0; i < m_vertex_count; ++i)
+  {
+    Vector3fMap mapped_position(&(m_positions[3 * i + 0]));
+    mapped_position = change * Vector3f(m_source_positions[3 * i + 0], m_source_positions[3 * i + 1], m_source_positions[3 * i + 2]);
   }
+
+  Eigen::Matrix3f normal_change = change.linear().inverse().transpose();
+  for(size_t i = 0; i < m_normals.size(); ++i)
+    m_normals[i] = octahedralEncode(normal_change * octahedralDecode(m_source_normals[i]));
 }
 
 void PolygonObject::texture(
@@ -49,17 +144,43 @@ void PolygonObject::texture(
   Vector2f* _output
   ) const
 {
-  const size_t _index_base = m_indices[3 * _primitive + 0];
-  const size_t _index_s = m_indices[3 * _primitive + 1];
-  const size_t _index_t = m_indices[3 * _primitive + 2];
+  const size_t _index_base = m_index_data[3 * _primitive + 0];
+  const size_t _index_s = m_index_data[3 * _primitive + 1];
+  const size_t _index_t = m_index_data[3 * _primitive + 2];
 
-  (*_output)[0] = (1.f - _s - _t) * m_texcoords[2 * _index_base + 0] + 
-  _s * m_texcoords[2 * _index_s + 0] + 
-  _t * m_texcoords[2 * _index_t + 0];
+  *_output = (1.f - _s - _t) * texcoord(_index_base) + 
+  _s * texcoord(_index_s) + 
+  _t * texcoord(_index_t);
+}
 
-  (*_output)[1] = (1.f - _s - _t) * m_texcoords[2 * _index_base + 1] + 
-  _s * m_texcoords[2 * _index_s + 1] + 
-  _t * m_texcoords[2 * _index_t + 1];
+float PolygonObject::density(const size_t _primitive) const
+{
+  return density(_primitive, Eigen::Matrix3f::Identity());
+}
+
+float PolygonObject::density(const size_t _primitive, const Eigen::Matrix3f& _linear) const
+{
+  const size_t _index_base = m_index_data[3 * _primitive + 0];
+  const size_t _index_s = m_index_data[3 * _primitive + 1];
+  const size_t _index_t = m_index_data[3 * _primitive + 2];
+
+  Vector3f position_base = position(_index_base);
+  Vector3f position_s = position(_index_s);
+  Vector3f position_t = position(_index_t);
+
+  Vector2f texcoord_base = texcoord(_index_base);
+  Vector2f texcoord_s = texcoord(_index_s);
+  Vector2f texcoord_t = texcoord(_index_t);
+
+  float world_area = (_linear * (position_s - position_base)).cross(_linear * (position_t - position_base)).norm();
+  Vector2f texture_s = texcoord_s - texcoord_base;
+  Vector2f texture_t = texcoord_t - texcoord_base;
+  float texture_area = fabs(texture_s.x() * texture_t.y() - texture_s.y() * texture_t.x());
+
+  if(world_area < M_EPSILON)
+    return 0.f;
+
+  return sqrt(texture_area / world_area);
 }
 
 void PolygonObject::normal(
@@ -69,21 +190,195 @@ void PolygonObject::normal(
   Vector3f* _output
   ) const
 {
-  const size_t _index_base = m_indices[3 * _primitive + 0];
-  const size_t _index_s = m_indices[3 * _primitive + 1];
-  const size_t _index_t = m_indices[3 * _primitive + 2];
+  const size_t _index_base = m_index_data[3 * _primitive + 0];
+  const size_t _index_s = m_index_data[3 * _primitive + 1];
+  const size_t _index_t = m_index_data[3 * _primitive + 2];
+
+  *_output = (1.f - _s - _t) * octahedralDecode(m_normal_data[_index_base]) + 
+  _s * octahedralDecode(m_normal_data[_index_s]) + 
+  _t * octahedralDecode(m_normal_data[_index_t]);
+}
+
+void PolygonObject::interpolateTexcoords(
+  const size_t _size,
+  const int* _primitives,
+  const float* _s,
+  const float* _t,
+  float* _u,
+  float* _v,
+  float* _density
+  ) const
+{
+  interpolateTexcoords(_size, _primitives, _s, _t, Eigen::Matrix3f::Identity(), _u, _v, _density);
+}
+
+void PolygonObject::interpolateTexcoords(
+  const size_t _size,
+  const int* _primitives,
+  const float* _s,
+  const float* _t,
+  const Eigen::Matrix3f& _linear,
+  float* _u,
+  float* _v,
+  float* _density
+  ) const
+{
+  // Meshes without texture coordinates map every hit to the origin with no density
+  if(m_texcoord_unit_data == NULL && m_texcoord_data == NULL)
+  {
+    std::fill(_u, _u + _size, 0.f);
+    std::fill(_v, _v + _size, 0.f);
+    if(_density != NULL)
+      std::fill(_density, _density + _size, 0.f);
+
+    return;
+  }
+
+  // Storage is decided once for the range so each loop only gathers and interpolates
+  if(m_texcoord_unit_data != NULL)
+  {
+    const uint16_t* units = m_texcoord_unit_data;
+    float lower_u = m_texcoord_lower.x();
+    float lower_v = m_texcoord_lower.y();
+    float scale_u = m_texcoord_extent.x() / 65535.f;
+    float scale_v = m_texcoord_extent.y() / 65535.f;
+
+    for(size_t index = 0; index < _size; ++index)
+    {
+      const unsigned int* triangle = m_index_data + 3 * _primitives[index];
+      float weight = 1.f - _s[index] - _t[index];
+
+      _u[index] = lower_u + scale_u * (weight * units[2 * triangle[0] + 0]
+        + _s[index] * units[2 * triangle[1] + 0]
+        + _t[index] * units[2 * triangle[2] + 0]);
+
+      _v[index] = lower_v + scale_v * (weight * units[2 * triangle[0] + 1]
+        + _s[index] * units[2 * triangle[1] + 1]
+        + _t[index] * units[2 * triangle[2] + 1]);
+    }
+  }
+  else
+  {
+    const float* texcoords = m_texcoord_data;
+
+    for(size_t index = 0; index < _size; ++index)
+    {
+      const unsigned int* triangle = m_index_data + 3 * _primitives[index];
+      float weight = 1.f - _s[index] - _t[index];
+
+      _u[index] = weight * texcoords[2 * triangle[0] + 0]
+        + _s[index] * texcoords[2 * triangle[1] + 0]
+        + _t[index] * texcoords[2 * triangle[2] + 0];
+
+      _v[index] = weight * texcoords[2 * triangle[0] + 1]
+        + _s[index] * texcoords[2 * triangle[1] + 1]
+        + _t[index] * texcoords[2 * triangle[2] + 1];
+    }
+  }
+
+  if(_density == NULL)
+    return;
+
+  for(size_t index = 0; index < _size; ++index)
+    _density[index] = density(_primitives[index], _linear);
+}
+
+void PolygonObject::interpolateNormals(
+  const size_t _size,
+  const int* _primitives,
+  const float* _s,
+  const float* _t,
+  float* _x,
+  float* _y,
+  float* _z
+  ) const
+{
+  // Meshes without normals are shaded flat with the geometric normal of each triangle
+  if(m_normal_data == NULL)
+  {
+    for(size_t index = 0; index < _size; ++index)
+    {
+      const unsigned int* triangle = m_index_data + 3 * _primitives[index];
+
+      Vector3f base = position(triangle[0]);
+      Vector3f normal = (position(triangle[1]) - base).cross(position(triangle[2]) - base);
 
-  (*_output)[0] = (1.f - _s - _t) * m_normals[3 * _index_base + 0] + 
-  _s * m_normals[3 * _index_s + 0] + 
-  _t * m_normals[3 * _index_t + 0];
+      _x[index] = normal.x();
+      _y[index] = normal.y();
+      _z[index] = normal.z();
+    }
 
-  (*_output)[1] = (1.f - _s - _t) * m_normals[3 * _index_base + 1] + 
-  _s * m_normals[3 * _index_s + 1] + 
-  _t * m_normals[3 * _index_t + 1];
+    return;
+  }
+
+  for(size_t index = 0; index < _size; ++index)
+  {
+    const unsigned int* triangle = m_index_data + 3 * _primitives[index];
 
-  (*_output)[2] = (1.f - _s - _t) * m_normals[3 * _index_base + 2] + 
-  _s * m_normals[3 * _index_s + 2] + 
-  _t * m_normals[3 * _index_t + 2];
+    Vector3f normal = (1.f - _s[index] - _t[index]) * octahedralDecode(m_normal_data[triangle[0]])
+      + _s[index] * octahedralDecode(m_normal_data[triangle[1]])
+      + _t[index] * octahedralDecode(m_normal_data[triangle[2]]);
+
+    _x[index] = normal.x();
+    _y[index] = normal.y();
+    _z[index] = normal.z();
+  }
+}
+
+void PolygonObject::compact()
+{
+  m_texcoord_units.clear();
+  m_texcoord_lower = Vector2f(0.f, 0.f);
+  m_texcoord_extent = Vector2f(0.f, 0.f);
+
+  if(m_texcoords.empty())
+    return;
+
+  Vector2f lower(std::numeric_limits< float >::max(), std::numeric_limits< float >::max());
+  Vector2f upper(-std::numeric_limits< float >::max(), -std::numeric_limits< float >::max());
+  for(size_t i = 0; i < m_texcoords.size() / 2; ++i)
+  {
+    lower = lower.cwiseMin(Vector2f(m_texcoords[2 * i + 0], m_texcoords[2 * i + 1]));
+    upper = upper.cwiseMax(Vector2f(m_texcoords[2 * i + 0], m_texcoords[2 * i + 1]));
+  }
+
+  // Units only keep the precision of floats in the unit square when the range spans one tile
+  Vector2f extent = upper - lower;
+  if(extent.maxCoeff() > 1.f)
+    return;
+
+  m_texcoord_units.resize(m_texcoords.size());
+  for(size_t i = 0; i < m_texcoords.size(); ++i)
+  {
+    float range = extent[i % 2];
+    float unit = (range > 0.f) ? (m_texcoords[i] - lower[i % 2]) / range : 0.f;
+    m_texcoord_units[i] = uint16_t(floor(unit * 65535.f + 0.5f));
+  }
+
+  m_texcoord_lower = lower;
+  m_texcoord_extent = extent;
+  std::vector< float >().swap(m_texcoords);
+}
+
+void PolygonObject::view()
+{
+  m_position_data = m_positions.empty() ? NULL : &(m_positions[0]);
+  m_normal_data = m_normals.empty() ? NULL : &(m_normals[0]);
+  m_texcoord_data = m_texcoords.empty() ? NULL : &(m_texcoords[0]);
+  m_texcoord_unit_data = m_texcoord_units.empty() ? NULL : &(m_texcoord_units[0]);
+  m_index_data = m_indices.empty() ? NULL : &(m_indices[0]);
+  m_vertex_count = m_positions.size() / 3;
+  m_triangle_count = m_indices.size() / 3;
+}
+
+Affine3f PolygonObject::placement() const
+{
+  return Affine3f::Identity()
+   * Eigen::Translation3f(m_translation)
+   * Eigen::AngleAxisf(m_rotation.x() * M_PI_180, Vector3f::UnitX())
+   * Eigen::AngleAxisf(m_rotation.y() * M_PI_180, Vector3f::UnitY())
+   * Eigen::AngleAxisf(m_rotation.z() * M_PI_180, Vector3f::UnitZ())
+   * Eigen::AlignedScaling3f(m_scale);
 }
 
 MSC_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include <core/Prefetch.h>
+#include <core/Integrator.h>
+#include <core/ShadingKey.h>
+
+MSC_NAMESPACE_BEGIN
+
+Prefetch::Prefetch(Scene* _scene, Settings* _settings, TextureSystem _texture_system)
+ : m_scene(_scene)
+ , m_settings(_settings)
+ , m_texture_system(_texture_system)
+ , m_batch(NULL)
+ , m_shaded_size(0)
+ , m_first(0)
+ , m_claimed(0)
+ , m_generation(0)
+ , m_active(0)
+ , m_cancel(true)
+ , m_stop(false)
+{
+  for(size_t index = 0; index < m_settings->prefetch_threads; ++index)
+    m_threads.create_thread(boost::bind(&Prefetch::worker, this));
+}
+
+Prefetch::~Prefetch()
+{
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_stop = true;
+    m_cancel = true;
+  }
+
+  m_condition.notify_all();
+  m_threads.join_all();
+}
+
+void Prefetch::begin(RayUncompressed* _batch, const size_t _size)
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+
+  // Ranges of equal geometry no larger than the shading size, as divided by the integrator
+  m_batch = _batch;
+  m_ranges.clear();
+
+  size_t begin = 0;
+  while(begin < _size)
+  {
+    size_t end = begin + 1;
+    while(end < _size && end - begin < m_settings->shading_size && _batch[end].geomID == _batch[begin].geomID)
+      ++end;
+
+    m_ranges.push_back(begin);
+    begin = end;
+  }
+
+  m_ranges.push_back(_size);
+
+  size_t count = m_ranges.size() - 1;
+  if(m_shaded_size < count)
+  {
+    m_shaded.reset(new boost::atomic< bool >[count]);
+    m_shaded_size = count;
+  }
+
+  for(size_t index = 0; index < count; ++index)
+    m_shaded[index].store(false, boost::memory_order_relaxed);
+
+  // Shading starts from the first range so prefetching starts halfway through the batch
+  m_first = count / 2;
+  m_claimed = 0;
+  m_cancel = false;
+  ++m_generation;
+
+  m_condition.notify_all();
+}
+
+void Prefetch::shading(const size_t _begin)
+{
+  size_t range = std::upper_bound(m_ranges.begin(), m_ranges.end(), _begin) - m_ranges.begin() - 1;
+  m_shaded[range].store(true, boost::memory_order_relaxed);
+}
+
+void Prefetch::end()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_cancel = true;
+
+  while(m_active > 0)
+    m_condition.wait(lock);
+}
+
+void Prefetch::worker()
+{
+  TexturePerthread texture_info = m_texture_system->get_perthread_info();
+  size_t generation = 0;
+
+  while(true)
+  {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      while(!m_stop && (generation == m_generation || m_cancel))
+        m_condition.wait(lock);
+
+      if(m_stop)
+        return;
+
+      generation = m_generation;
+      ++m_active;
+    }
+
+    run(texture_info);
+
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      --m_active;
+    }
+
+    m_condition.notify_all();
+  }
+}
+
+void Prefetch::run(TexturePerthread _texture_info)
+{
+  std::vector< float > u;
+  std::vector< float > v;
+  std::vector< float > footprint;
+
+  size_t count = m_ranges.size() - 1;
+
+  while(!m_cancel)
+  {
+    size_t claim = m_claimed.fetch_add(1);
+    if(claim >= count)
+      return;
+
+    // Ranges shading has already reached are of no use
+    size_t range = (m_first + claim) % count;
+    if(m_shaded[range].load(boost::memory_order_relaxed))
+      continue;
+
+    size_t begin = m_ranges[range];
+    size_t size = m_ranges[range + 1] - begin;
+
+    // Nothing was hit
+    if(m_batch[begin].geomID == -1)
+      continue;
+
+    ObjectInterface* object = m_scene->objects[m_batch[begin].geomID].get();
+
+    // Lights have no textures
+    if(m_scene->shaders_to_lights.find(object->shader()) != m_scene->shaders_to_lights.end())
+      continue;
+
+    Integrator::coordinates(object, &(m_batch[begin]), size, 1, &u, &v, &footprint);
+
+    // Keep one point for every change of texture tile, sorted points rarely change tile
+    size_t points = 0;
+    unsigned int previous = 0;
+    for(size_t index = 0; index < u.size(); ++index)
+    {
+      unsigned int tile = textureTile(u[index], v[index], footprint[index]);
+      if(points > 0 && tile == previous)
+        continue;
+
+      u[points] = u[index];
+      v[points] = v[index];
+      footprint[points] = footprint[index];
+      previous = tile;
+      ++points;
+    }
+
+    m_scene->shaders[object->shader()]->prefetch(points, &(u[0]), &(v[0]), &(footprint[0]), m_texture_system, _texture_info);
+  }
+}
+
+MSC_NAMESPACE_END
@@ -2,10 +2,39 @@
 
 MSC_NAMESPACE_BEGIN
 
-//Generate uniform sample (mutates class)
-float RandomGenerator::sample()
+//Generate uniform samples (mutates class)
+void RandomGenerator::sample(const size_t _count, float* _output)
 {
-  return m_uniform_dist(m_generator);
+  if(m_sequence)
+  {
+    for(size_t index = 0; index < _count; ++index)
+      _output[index] = sequenceSample(m_key, m_index, m_counter + index);
+  }
+  else
+  {
+    for(size_t index = 0; index < _count; ++index)
+      _output[index] = uniformSample(m_key, m_counter + index);
+  }
+
+  m_counter += _count;
+}
+
+//Reseed generator (mutates class)
+void RandomGenerator::seed(const boost::uint64_t _seed, const boost::uint32_t _dimension)
+{
+  m_key = mixBits(_seed);
+  m_index = 0;
+  m_counter = _dimension;
+  m_sequence = false;
+}
+
+//Reseed generator to a sequence point (mutates class)
+void RandomGenerator::sequence(const boost::uint64_t _seed, const boost::uint32_t _index, const boost::uint32_t _dimension)
+{
+  m_key = mixBits(_seed);
+  m_index = _index;
+  m_counter = _dimension;
+  m_sequence = true;
 }
 
-MSC_NAMESPACE_END
\ No newline at end of file
+MSC_NAMESPACE_END
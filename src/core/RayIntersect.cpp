@@ -8,7 +8,16 @@ void RayIntersect::operator()(const tbb::blocked_range< size_t >& r) const
 {
   // Test packing data for sse vectorization 
   for(size_t index = r.begin(); index < r.end(); ++index)
-    rtcIntersect(m_scene->rtc_scene, m_data[index].rtc_ray);
+  {
+    if(m_scene->geometry_cache)
+      m_scene->geometry_cache->intersect(m_scene->rtc_scene, m_data[index].rtc_ray);
+    else
+      rtcIntersect(m_scene->rtc_scene, m_data[index].rtc_ray);
+
+    // Instances are shaded as a whole so hits refer to the instance rather than its geometry
+    if(m_data[index].instID != int(RTC_INVALID_GEOMETRY_ID))
+      m_data[index].geomID = m_data[index].instID;
+  }
 }
 
 MSC_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <core/RayPacket.h>
+
+MSC_NAMESPACE_BEGIN
+
+void RayPacket::operator()(const tbb::blocked_range< size_t >& r) const
+{
+  RTCRay4 packet;
+  RTCORE_ALIGN(16) int valid[4];
+
+  for(size_t begin = r.begin(); begin < r.end(); begin += 4)
+  {
+    size_t size = std::min(size_t(4), r.end() - begin);
+
+    for(size_t lane = 0; lane < 4; ++lane)
+    {
+      // Inactive lanes repeat the first ray so that the packet stays coherent
+      const RayUncompressed& ray = m_data[begin + ((lane < size) ? lane : 0)];
+      valid[lane] = (lane < size) ? -1 : 0;
+
+      packet.orgx[lane] = ray.org[0];
+      packet.orgy[lane] = ray.org[1];
+      packet.orgz[lane] = ray.org[2];
+      packet.dirx[lane] = ray.dir[0];
+      packet.diry[lane] = ray.dir[1];
+      packet.dirz[lane] = ray.dir[2];
+      packet.tnear[lane] = ray.tnear;
+      packet.tfar[lane] = ray.tfar;
+      packet.time[lane] = ray.time;
+      packet.mask[lane] = ray.mask;
+      packet.geomID[lane] = RTC_INVALID_GEOMETRY_ID;
+      packet.primID[lane] = RTC_INVALID_GEOMETRY_ID;
+      packet.instID[lane] = RTC_INVALID_GEOMETRY_ID;
+    }
+
+    rtcIntersect4(valid, m_scene->rtc_scene, packet);
+
+    for(size_t lane = 0; lane < size; ++lane)
+    {
+      RayUncompressed& ray = m_data[begin + lane];
+
+      ray.tfar = packet.tfar[lane];
+      ray.Ng[0] = packet.Ngx[lane];
+      ray.Ng[1] = packet.Ngy[lane];
+      ray.Ng[2] = packet.Ngz[lane];
+      ray.u = packet.u[lane];
+      ray.v = packet.v[lane];
+      ray.geomID = (packet.instID[lane] != RTC_INVALID_GEOMETRY_ID) ? packet.instID[lane] : packet.geomID[lane];
+      ray.primID = packet.primID[lane];
+      ray.instID = packet.instID[lane];
+    }
+  }
+}
+
+MSC_NAMESPACE_END
@@ -0,0 +1,11 @@
+#include <core/RayRequest.h>
+
+MSC_NAMESPACE_BEGIN
+
+void RayRequest::operator()(const tbb::blocked_range< size_t >& r) const
+{
+  for(size_t index = r.begin(); index < r.end(); ++index)
+    m_scene->geometry_cache->request(m_scene->rtc_scene, m_data[index].rtc_ray);
+}
+
+MSC_NAMESPACE_END
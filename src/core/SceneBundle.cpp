@@ -0,0 +1,277 @@
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include <core/SceneBundle.h>
+#include <core/PolygonObject.h>
+#include <core/InstanceObject.h>
+#include <core/Singleton.h>
+
+MSC_NAMESPACE_BEGIN
+
+namespace
+{
+  const char bundle_magic[4] = {'M', 'S', 'C', 'B'};
+  const boost::uint32_t bundle_version = 3;
+  const boost::uint64_t bundle_alignment = 64;
+
+  struct BundleHeader
+  {
+    char magic[4];
+    boost::uint32_t version;
+    boost::uint64_t directory_offset;
+    boost::uint64_t directory_size;
+    boost::uint64_t document_offset;
+    boost::uint64_t document_size;
+    boost::uint64_t meshes_offset;
+    boost::uint64_t meshes_size;
+  };
+
+  // Writes an array at the next aligned offset and returns that offset
+  boost::uint64_t writeAligned(std::ofstream& _stream, const void* _data, const size_t _bytes)
+  {
+    static const char padding[bundle_alignment] = {0};
+
+    boost::uint64_t position = _stream.tellp();
+    boost::uint64_t offset = (position + bundle_alignment - 1) & ~(bundle_alignment - 1);
+    _stream.write(padding, offset - position);
+
+    if(_bytes > 0)
+      _stream.write(static_cast< const char* >(_data), _bytes);
+
+    return offset;
+  }
+
+  // Tests that an array of elements lies within a file without overflowing
+  bool withinFile(const boost::uint64_t _offset, const boost::uint64_t _size, const size_t _element, const size_t _file)
+  {
+    return _offset <= _file && _size <= (_file - _offset) / _element;
+  }
+}
+
+SceneBundle::SceneBundle(const std::string& _filename)
+ : m_meshes(NULL)
+ , m_mesh_count(0)
+{
+  try
+  {
+    m_file.open(_filename);
+  }
+  catch(const std::exception&)
+  {
+    throw std::runtime_error("could not map scene bundle " + _filename);
+  }
+
+  const BundleHeader* header = reinterpret_cast< const BundleHeader* >(m_file.data());
+  if(m_file.size() < sizeof(BundleHeader) || std::memcmp(header->magic, bundle_magic, 4) != 0)
+    throw std::runtime_error(_filename + " is not a scene bundle");
+
+  if(header->version != bundle_version)
+    throw std::runtime_error(_filename + " was compiled by a different version and must be compiled again");
+
+  if(!withinFile(header->directory_offset, header->directory_size, 1, m_file.size())
+    || !withinFile(header->document_offset, header->document_size, 1, m_file.size())
+    || !withinFile(header->meshes_offset, header->meshes_size, sizeof(BundleMesh), m_file.size()))
+    throw std::runtime_error(_filename + " is truncated");
+
+  m_meshes = reinterpret_cast< const BundleMesh* >(data(header->meshes_offset));
+  m_mesh_count = header->meshes_size;
+
+  // Geometry is handed to embree and released by page without further checks
+  for(size_t index = 0; index < m_mesh_count; ++index)
+  {
+    const BundleMesh& mesh = m_meshes[index];
+    size_t texcoord_element = (mesh.texcoord_bits == 16) ? sizeof(boost::uint16_t) : sizeof(float);
+
+    if(!withinFile(mesh.positions_offset, mesh.positions_size, sizeof(float), m_file.size())
+      || !withinFile(mesh.normals_offset, mesh.normals_size, sizeof(boost::uint32_t), m_file.size())
+      || !withinFile(mesh.texcoords_offset, mesh.texcoords_size, texcoord_element, m_file.size())
+      || !withinFile(mesh.indices_offset, mesh.indices_size, sizeof(unsigned int), m_file.size()))
+      throw std::runtime_error(_filename + " is truncated");
+  }
+}
+
+bool SceneBundle::identify(const std::string& _filename)
+{
+  char magic[4] = {0};
+
+  std::ifstream stream(_filename.c_str(), std::ios::binary);
+  stream.read(magic, 4);
+
+  return stream && std::memcmp(magic, bundle_magic, 4) == 0;
+}
+
+void SceneBundle::compile(const std::string& _scene, const std::string& _bundle)
+{
+  std::ifstream input(_scene.c_str(), std::ios::binary);
+  if(!input)
+    throw std::runtime_error("could not read scene file " + _scene);
+
+  std::stringstream buffer;
+  buffer << input.rdbuf();
+  std::string document = buffer.str();
+
+  std::string directory = boost::filesystem::absolute(boost::filesystem::path(_scene).parent_path()).string();
+
+  std::vector<YAML::Node> node_root = YAML::LoadAll(document);
+  if(node_root.size() < 2)
+    throw std::runtime_error(_scene + " is missing the setup or scene document");
+
+  SingletonString& scene_root = SingletonString::instance();
+  scene_root.setData(directory);
+
+  std::string temporary = _bundle + ".tmp";
+  std::ofstream output(temporary.c_str(), std::ios::binary | std::ios::trunc);
+  if(!output)
+    throw std::runtime_error("could not write scene bundle " + _bundle);
+
+  BundleHeader header;
+  std::memset(&header, 0, sizeof(BundleHeader));
+  output.write(reinterpret_cast< const char* >(&header), sizeof(BundleHeader));
+
+  std::memcpy(header.magic, bundle_magic, 4);
+  header.version = bundle_version;
+  header.directory_offset = writeAligned(output, directory.data(), directory.size());
+  header.directory_size = directory.size();
+  header.document_offset = writeAligned(output, document.data(), document.size());
+  header.document_size = document.size();
+
+  // Geometry is written in the order objects and first instances of each file appear so the
+  // renderer can match them up again
+  std::vector< BundleMesh > meshes;
+  std::set< std::string > instanced;
+  YAML::Node node_scene = node_root[1];
+  for(YAML::const_iterator scene_iterator = node_scene.begin(); scene_iterator != node_scene.end(); ++scene_iterator)
+  {
+    YAML::Node first = scene_iterator->first;
+    YAML::Node second = scene_iterator->second;
+
+    if(second["type"].as< std::string >() != "Polygon")
+      continue;
+
+    PolygonObject polygon_object;
+    if(first.as< std::string >() == "object")
+    {
+      polygon_object = second.as<PolygonObject>();
+    }
+    else if(first.as< std::string >() == "instance")
+    {
+      InstanceObject instance_object = second.as<InstanceObject>();
+      if(!instanced.insert(instance_object.filename()).second)
+        continue;
+
+      polygon_object.filename(instance_object.filename());
+    }
+    else
+    {
+      continue;
+    }
+
+    polygon_object.construct();
+
+    BundleMesh mesh;
+    std::memset(&mesh, 0, sizeof(BundleMesh));
+    mesh.positions_size = polygon_object.vertices() ? 3 * polygon_object.vertices() + 1 : 0;
+    mesh.positions_offset = writeAligned(output, polygon_object.positions(), mesh.positions_size * sizeof(float));
+    mesh.normals_size = polygon_object.normals() ? polygon_object.vertices() : 0;
+    mesh.normals_offset = writeAligned(output, polygon_object.normals(), mesh.normals_size * sizeof(boost::uint32_t));
+
+    if(polygon_object.texcoordUnits())
+    {
+      mesh.texcoord_bits = 16;
+      mesh.texcoords_size = 2 * polygon_object.vertices();
+      mesh.texcoords_offset = writeAligned(output, polygon_object.texcoordUnits(), mesh.texcoords_size * sizeof(boost::uint16_t));
+    }
+    else
+    {
+      mesh.texcoord_bits = 32;
+      mesh.texcoords_size = polygon_object.texcoords() ? 2 * polygon_object.vertices() : 0;
+      mesh.texcoords_offset = writeAligned(output, polygon_object.texcoords(), mesh.texcoords_size * sizeof(float));
+    }
+
+    mesh.texcoord_lower[0] = polygon_object.texcoordLower().x();
+    mesh.texcoord_lower[1] = polygon_object.texcoordLower().y();
+    mesh.texcoord_extent[0] = polygon_object.texcoordExtent().x();
+    mesh.texcoord_extent[1] = polygon_object.texcoordExtent().y();
+
+    mesh.indices_size = 3 * polygon_object.triangles();
+    mesh.indices_offset = writeAligned(output, polygon_object.indices(), mesh.indices_size * sizeof(unsigned int));
+
+    for(size_t axis = 0; axis < 3; ++axis)
+    {
+      mesh.lower[axis] = std::numeric_limits< float >::max();
+      mesh.upper[axis] = -std::numeric_limits< float >::max();
+    }
+
+    for(size_t vertex = 0; vertex < polygon_object.vertices(); ++vertex)
+    {
+      for(size_t axis = 0; axis < 3; ++axis)
+      {
+        mesh.lower[axis] = std::min(mesh.lower[axis], polygon_object.positions()[3 * vertex + axis]);
+        mesh.upper[axis] = std::max(mesh.upper[axis], polygon_object.positions()[3 * vertex + axis]);
+      }
+    }
+
+    meshes.push_back(mesh);
+  }
+
+  header.meshes_offset = writeAligned(output, meshes.empty() ? NULL : &(meshes[0]), meshes.size() * sizeof(BundleMesh));
+  header.meshes_size = meshes.size();
+
+  // The header is only written once everything else succeeded
+  output.seekp(0);
+  output.write(reinterpret_cast< const char* >(&header), sizeof(BundleHeader));
+  output.close();
+
+  if(!output)
+    throw std::runtime_error("could not write scene bundle " + _bundle);
+
+  boost::filesystem::rename(temporary, _bundle);
+}
+
+std::string SceneBundle::document() const
+{
+  const BundleHeader* header = reinterpret_cast< const BundleHeader* >(m_file.data());
+  return std::string(data(header->document_offset), header->document_size);
+}
+
+std::string SceneBundle::directory() const
+{
+  const BundleHeader* header = reinterpret_cast< const BundleHeader* >(m_file.data());
+  return std::string(data(header->directory_offset), header->directory_size);
+}
+
+size_t SceneBundle::meshes() const
+{
+  return m_mesh_count;
+}
+
+const BundleMesh& SceneBundle::mesh(const size_t _index) const
+{
+  return m_meshes[_index];
+}
+
+void SceneBundle::release(const size_t _index) const
+{
+  const BundleMesh& mesh = m_meshes[_index];
+
+  // Only whole pages that lie within the arrays of this mesh can be dropped
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t base = reinterpret_cast< size_t >(m_file.data());
+  size_t begin = (base + mesh.positions_offset + page_size - 1) & ~(page_size - 1);
+  size_t end = (base + mesh.indices_offset + mesh.indices_size * sizeof(unsigned int)) & ~(page_size - 1);
+
+  if(begin < end)
+    madvise(reinterpret_cast< void* >(begin), end - begin, MADV_DONTNEED);
+}
+
+MSC_NAMESPACE_END
@@ -0,0 +1,62 @@
+#include <core/ShadingKey.h>
+
+MSC_NAMESPACE_BEGIN
+
+namespace
+{
+  // Approximate tile width of the texture cache in texels
+  const float tile_texels = 64.f;
+  const unsigned int max_level = 12;
+
+  // Spread the lower bits of a value out to every other bit
+  unsigned int spreadBits(unsigned int _value)
+  {
+    _value &= 0x00000FFF;
+    _value = (_value | (_value << 8)) & 0x00FF00FF;
+    _value = (_value | (_value << 4)) & 0x0F0F0F0F;
+    _value = (_value | (_value << 2)) & 0x33333333;
+    _value = (_value | (_value << 1)) & 0x55555555;
+    return _value;
+  }
+}
+
+unsigned int textureTile(const float _u, const float _v, const float _footprint)
+{
+  // Number of cache tiles across texture space at the level selected by the footprint
+  unsigned int level = max_level;
+  if(_footprint > 0.f)
+    level = std::min(max_level, static_cast< unsigned int >(std::max(0.f, -log2f(_footprint * tile_texels))));
+
+  float resolution = static_cast< float >(1 << level);
+  unsigned int tile_u = static_cast< unsigned int >((_u - floorf(_u)) * resolution);
+  unsigned int tile_v = static_cast< unsigned int >((_v - floorf(_v)) * resolution);
+
+  return (level << 24) | spreadBits(tile_u) | (spreadBits(tile_v) << 1);
+}
+
+void ShadingKey::operator()(const tbb::blocked_range< size_t >& r) const
+{
+  for(size_t index = r.begin(); index < r.end(); ++index)
+  {
+    RayUncompressed& hit = m_batch[index];
+    hit.shadingKey = 0;
+
+    if(hit.geomID == -1)
+      continue;
+
+    ObjectInterface* object = m_scene->objects[hit.geomID].get();
+
+    // Lights have no textures
+    if(m_scene->shaders_to_lights.find(object->shader()) != m_scene->shaders_to_lights.end())
+      continue;
+
+    Vector2f texture;
+    object->texture(hit.primID, hit.u, hit.v, &texture);
+
+    float footprint = (hit.coneWidth + hit.coneSpread * hit.tfar) * object->density(hit.primID);
+
+    hit.shadingKey = textureTile(texture[0], texture[1], footprint);
+  }
+}
+
+MSC_NAMESPACE_END
@@ -0,0 +1,11 @@
+#include <core/SobolSampler.h>
+
+MSC_NAMESPACE_BEGIN
+
+void SobolSampler::sample(const int _base, RandomGenerator* _random, float* _output) const
+{
+  boost::uint64_t key = mixBits(_random->bits());
+  sequenceSamples(key, 0, 0, _base * _base, _output);
+}
+
+MSC_NAMESPACE_END
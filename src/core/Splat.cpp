@@ -0,0 +1,90 @@
+#include <vector>
+#include <algorithm>
+
+#include <core/Splat.h>
+
+MSC_NAMESPACE_BEGIN
+
+namespace
+{
+  struct CompareContribution
+  {
+    bool operator()(const Contribution& _lhs, const size_t _rhs) const
+    {
+      return _lhs.sampleID < _rhs;
+    }
+  };
+}
+
+void Splat::operator()(const tbb::blocked_range< size_t >& r) const
+{
+  int width = m_image->width;
+  int height = m_image->height;
+  int margin = m_filter->margin();
+  size_t count = m_image->base * m_image->base;
+  size_t stripe_samples = m_stripe * width * count;
+
+  std::vector< float > positions(count * 2);
+  std::vector< float > weight_x(2 * margin + 1);
+  std::vector< float > weight_y(2 * margin + 1);
+  RandomGenerator pixel_random;
+
+  for(size_t pair = r.begin(); pair < r.end(); ++pair)
+  {
+    size_t stripe = 2 * pair + m_phase;
+
+    Contribution* begin = std::lower_bound(m_data, m_data + m_size, stripe * stripe_samples, CompareContribution());
+    Contribution* end = std::lower_bound(begin, m_data + m_size, (stripe + 1) * stripe_samples, CompareContribution());
+
+    size_t current_pixel = size_t(-1);
+    int pixel_x = 0;
+    int pixel_y = 0;
+
+    for(Contribution* contribution = begin; contribution != end; ++contribution)
+    {
+      size_t pixel = contribution->sampleID / count;
+      size_t index_sample = contribution->sampleID % count;
+
+      if(pixel != current_pixel)
+      {
+        current_pixel = pixel;
+        pixel_x = pixel % width;
+        pixel_y = pixel / width;
+
+        pixel_random.seed(pixelSeed(pixel_y * width + pixel_x, m_image->iteration));
+        m_sampler->sample(m_image->base, &pixel_random, &(positions[0]));
+      }
+
+      float sample_pos_x = pixel_x + positions[2 * index_sample + 0];
+      float sample_pos_y = pixel_y + positions[2 * index_sample + 1];
+
+      int target_x_begin = std::max(0, pixel_x - margin);
+      int target_x_end = std::min(width, pixel_x + margin + 1);
+      int target_y_begin = std::max(0, pixel_y - margin);
+      int target_y_end = std::min(height, pixel_y + margin + 1);
+
+      for(int target_x = target_x_begin; target_x < target_x_end; ++target_x)
+        weight_x[target_x - target_x_begin] = m_filter->evaluate(target_x + 0.5f - sample_pos_x);
+
+      for(int target_y = target_y_begin; target_y < target_y_end; ++target_y)
+        weight_y[target_y - target_y_begin] = m_filter->evaluate(target_y + 0.5f - sample_pos_y);
+
+      for(int target_y = target_y_begin; target_y < target_y_end; ++target_y)
+      {
+        Pixel* splats = &(m_image->splats[target_y * width]);
+
+        for(int target_x = target_x_begin; target_x < target_x_end; ++target_x)
+        {
+          float multiplier = weight_y[target_y - target_y_begin] * weight_x[target_x - target_x_begin];
+          Pixel& splat = splats[target_x];
+
+          splat.r += contribution->r * multiplier;
+          splat.g += contribution->g * multiplier;
+          splat.b += contribution->b * multiplier;
+        }
+      }
+    }
+  }
+}
+
+MSC_NAMESPACE_END
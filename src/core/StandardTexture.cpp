@@ -8,43 +8,92 @@ TextureInterface* StandardTexture::clone()
   return new StandardTexture(*this);
 }
 
-void StandardTexture::initialize(
+void StandardTexture::preconvert(TextureConverter* _converter)
+{
+  _converter->insert(this);
+}
+
+void StandardTexture::resolve(TextureSystem _texture_system)
+{
+  m_handle = _texture_system->get_texture_handle(m_string);
+}
+
+TextureOperand StandardTexture::compile(TextureProgram* _program, const size_t _runflags) const
+{
+  return _program->lookup(this, _runflags);
+}
+
+void StandardTexture::lookup(
   const size_t _size,
+  OpenImageIO::Runflag* _runflags,
   std::vector< float >& _u,
   std::vector< float >& _v,
-  TextureSystem _texture_system
-  )
+  std::vector< float >& _footprint,
+  TextureSystem _texture_system,
+  TexturePerthread _thread_info,
+  float* _output
+  ) const
 {
   OpenImageIO::TextureOptions options;
   options.swrap = OpenImageIO::TextureOptions::WrapPeriodic;
   options.twrap = OpenImageIO::TextureOptions::WrapPeriodic;
-  std::vector< OpenImageIO::Runflag > runflags(_size, 1);
-  std::vector< float > temp_colour(_size * 3);
   
   float nullvalue = 0;
-  _texture_system->texture(
-    m_string,
-    options,
-    &(runflags[0]),
-    0, _size,
-    OpenImageIO::Varying(&(_u[0])), OpenImageIO::Varying(&(_v[0])),
-    OpenImageIO::Uniform(nullvalue), OpenImageIO::Uniform(nullvalue),
-    OpenImageIO::Uniform(nullvalue), OpenImageIO::Uniform(nullvalue),
-    3, &(temp_colour[0])
-    );
-
-  m_colour.resize(_size);
-  Colour3fMap mapped_data(NULL);
-  for(size_t index = 0; index < _size; ++index)
+
+  if(m_handle != NULL)
   {
-    new (&mapped_data) Colour3fMap((float*) &(temp_colour[3 * index + 0]));
-    m_colour[index] = mapped_data;
+    _texture_system->texture(
+      m_handle,
+      _thread_info,
+      options,
+      _runflags,
+      0, _size,
+      OpenImageIO::Varying(&(_u[0])), OpenImageIO::Varying(&(_v[0])),
+      OpenImageIO::Varying(&(_footprint[0])), OpenImageIO::Uniform(nullvalue),
+      OpenImageIO::Uniform(nullvalue), OpenImageIO::Varying(&(_footprint[0])),
+      3, _output
+      );
+  }
+  else
+  {
+    _texture_system->texture(
+      m_string,
+      options,
+      _runflags,
+      0, _size,
+      OpenImageIO::Varying(&(_u[0])), OpenImageIO::Varying(&(_v[0])),
+      OpenImageIO::Varying(&(_footprint[0])), OpenImageIO::Uniform(nullvalue),
+      OpenImageIO::Uniform(nullvalue), OpenImageIO::Varying(&(_footprint[0])),
+      3, _output
+      );
   }
 }
 
-Colour3f StandardTexture::colour(const size_t _index) const
+void StandardTexture::prefetch(
+  const size_t _size,
+  const float* _u,
+  const float* _v,
+  const float* _footprint,
+  TextureSystem _texture_system,
+  TexturePerthread _thread_info
+  ) const
 {
-  return m_colour[_index];
+  // Closest texel of the level selected by the footprint only reads the tile holding it
+  OpenImageIO::TextureOpt options;
+  options.swrap = OpenImageIO::TextureOptions::WrapPeriodic;
+  options.twrap = OpenImageIO::TextureOptions::WrapPeriodic;
+  options.mipmode = OpenImageIO::TextureOptions::MipModeOneLevel;
+  options.interpmode = OpenImageIO::TextureOptions::InterpClosest;
+
+  float texel = 0.f;
+
+  for(size_t index = 0; index < _size; ++index)
+  {
+    if(m_handle != NULL)
+      _texture_system->texture(m_handle, _thread_info, options, _u[index], _v[index], _footprint[index], 0.f, 0.f, _footprint[index], 1, &texel);
+    else
+      _texture_system->texture(m_string, options, _u[index], _v[index], _footprint[index], 0.f, 0.f, _footprint[index], 1, &texel);
+  }
 }
 
 MSC_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+
+#include <tbb/tbb.h>
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#include <OpenImageIO/imageio.h>
+#include <OpenImageIO/imagebufalgo.h>
+
+#include <core/TextureConverter.h>
+#include <core/StandardTexture.h>
+
+MSC_NAMESPACE_BEGIN
+
+namespace
+{
+  const char* mip_filter = "box";
+
+  // Fowler-Noll-Vo hash continued over a block of bytes
+  boost::uint64_t hashBytes(boost::uint64_t _hash, const char* _data, const size_t _size)
+  {
+    for(size_t index = 0; index < _size; ++index)
+    {
+      _hash ^= static_cast< unsigned char >(_data[index]);
+      _hash *= 1099511628211ULL;
+    }
+
+    return _hash;
+  }
+
+  std::string hashString(const boost::uint64_t _hash)
+  {
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << _hash;
+    return stream.str();
+  }
+
+  // Hash of the file contents and the conversion parameters
+  std::string contentHash(const std::string& _path, const std::string& _parameters)
+  {
+    std::ifstream file(_path.c_str(), std::ios::binary);
+    std::vector< char > buffer(1 << 16);
+
+    boost::uint64_t hash = hashBytes(14695981039346656037ULL, _parameters.data(), _parameters.size());
+    while(file)
+    {
+      file.read(&(buffer[0]), buffer.size());
+      hash = hashBytes(hash, &(buffer[0]), file.gcount());
+    }
+
+    return hashString(hash);
+  }
+
+  // Hash of the file path, size and modification time and the conversion parameters
+  std::string sourceHash(const std::string& _path, const std::string& _parameters)
+  {
+    boost::system::error_code error;
+    std::ostringstream stream;
+    stream << boost::filesystem::absolute(_path).string() << '\n'
+      << boost::filesystem::file_size(_path, error) << '\n'
+      << boost::filesystem::last_write_time(_path, error) << '\n'
+      << _parameters;
+
+    std::string key = stream.str();
+    return hashString(hashBytes(14695981039346656037ULL, key.data(), key.size()));
+  }
+
+  // Records which conversion a source resolves to, written atomically like the conversion itself
+  void writeReference(const boost::filesystem::path& _reference, const boost::filesystem::path& _cached)
+  {
+    boost::filesystem::path temp = _reference.parent_path() / boost::filesystem::unique_path("%%%%-%%%%-%%%%.ref");
+
+    {
+      std::ofstream stream(temp.string().c_str());
+      stream << _cached.filename().string();
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::rename(temp, _reference, error);
+    if(error)
+      boost::filesystem::remove(temp, error);
+  }
+
+  // Returns the path that should be given to the texture system
+  std::string convertFile(const std::string& _path, const std::string& _directory, const int _tile_size)
+  {
+    std::ostringstream parameters;
+    parameters << "tile " << _tile_size << " zip " << mip_filter;
+
+    // Sources that have not changed are found without reading them
+    boost::filesystem::path reference = boost::filesystem::path(_directory) / (sourceHash(_path, parameters.str()) + ".ref");
+    if(boost::filesystem::exists(reference))
+    {
+      std::string name;
+      std::ifstream stream(reference.string().c_str());
+      std::getline(stream, name);
+
+      boost::filesystem::path cached = boost::filesystem::path(_directory) / name;
+      if(!name.empty() && boost::filesystem::exists(cached))
+        return cached.string();
+    }
+
+    OpenImageIO::ImageInput* input = OpenImageIO::ImageInput::open(_path);
+
+    if(input == NULL)
+      return _path;
+
+    OpenImageIO::ImageSpec level;
+    bool tiled = input->spec().tile_width > 0;
+    bool mipmapped = input->seek_subimage(0, 1, level);
+
+    input->close();
+    OpenImageIO::ImageInput::destroy(input);
+
+    if(tiled && mipmapped)
+      return _path;
+
+    boost::filesystem::path cached = boost::filesystem::path(_directory) / (contentHash(_path, parameters.str()) + ".tx");
+
+    if(boost::filesystem::exists(cached))
+    {
+      writeReference(reference, cached);
+      return cached.string();
+    }
+
+    // Written under a unique name first so that concurrent renders never read partial files
+    boost::filesystem::path temp = boost::filesystem::path(_directory) / boost::filesystem::unique_path("%%%%-%%%%-%%%%.tx");
+
+    OpenImageIO::ImageSpec config;
+    config.tile_width = _tile_size;
+    config.tile_height = _tile_size;
+    config.attribute("compression", "zip");
+    config.attribute("maketx:filtername", mip_filter);
+
+    if(!OpenImageIO::ImageBufAlgo::make_texture(OpenImageIO::ImageBufAlgo::MakeTxTexture, _path, temp.string(), config))
+    {
+      std::cerr << "warning: unable to convert texture " << _path << ", " << OpenImageIO::geterror() << std::endl;
+
+      boost::system::error_code error;
+      boost::filesystem::remove(temp, error);
+      return _path;
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::rename(temp, cached, error);
+
+    if(error)
+    {
+      boost::filesystem::remove(temp, error);
+      return _path;
+    }
+
+    writeReference(reference, cached);
+    return cached.string();
+  }
+
+  struct ConvertFiles
+  {
+    const std::string* directory;
+    int tile_size;
+    const std::vector< std::string >* input;
+    std::vector< std::string >* output;
+
+    void operator()(const size_t _index) const
+    {
+      (*output)[_index] = convertFile((*input)[_index], *directory, tile_size);
+    }
+  };
+}
+
+void TextureConverter::insert(StandardTexture* _texture)
+{
+  m_textures.push_back(_texture);
+}
+
+void TextureConverter::convert()
+{
+  if(m_textures.empty())
+    return;
+
+  boost::system::error_code error;
+  boost::filesystem::create_directories(m_directory, error);
+
+  if(error)
+  {
+    std::cerr << "warning: unable to create texture directory " << m_directory << std::endl;
+    return;
+  }
+
+  // Each file is converted once however many textures share it
+  std::map< std::string, size_t > unique;
+  std::vector< std::string > input;
+  for(size_t index = 0; index < m_textures.size(); ++index)
+  {
+    std::string path = m_textures[index]->string();
+    if(unique.find(path) == unique.end())
+    {
+      unique[path] = input.size();
+      input.push_back(path);
+    }
+  }
+
+  std::vector< std::string > output(input.size());
+
+  ConvertFiles convert_files;
+  convert_files.directory = &m_directory;
+  convert_files.tile_size = m_tile_size;
+  convert_files.input = &input;
+  convert_files.output = &output;
+  tbb::parallel_for(size_t(0), input.size(), convert_files);
+
+  for(size_t index = 0; index < m_textures.size(); ++index)
+    m_textures[index]->string(output[unique[m_textures[index]->string()]]);
+
+  m_textures.clear();
+}
+
+MSC_NAMESPACE_END
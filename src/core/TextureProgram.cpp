@@ -0,0 +1,227 @@
+#include <core/TextureProgram.h>
+#include <core/TextureInterface.h>
+#include <core/StandardTexture.h>
+
+MSC_NAMESPACE_BEGIN
+
+void TextureProgram::compile(const TextureInterface* _texture)
+{
+  m_instructions.clear();
+  m_register_count = 0;
+  m_runflag_count = 1;
+
+  // Runflags at index zero are set for every point
+  m_result = _texture->compile(this, 0);
+
+  if(!m_result.constant)
+    return;
+
+  m_instructions.clear();
+  m_register_count = 0;
+  m_runflag_count = 1;
+}
+
+TextureOperand TextureProgram::constant(const Colour3f& _colour)
+{
+  TextureOperand operand;
+  operand.constant = true;
+  operand.colour = _colour;
+  operand.index = 0;
+  return operand;
+}
+
+TextureOperand TextureProgram::lookup(const StandardTexture* _texture, const size_t _runflags)
+{
+  TextureInstruction instruction;
+  instruction.operation = TEXTURE_LOOKUP;
+  instruction.output = m_register_count++;
+  instruction.runflags = _runflags;
+  instruction.texture = _texture;
+  m_instructions.push_back(instruction);
+
+  TextureOperand operand;
+  operand.constant = false;
+  operand.colour = Colour3f(0.f, 0.f, 0.f);
+  operand.index = instruction.output;
+  return operand;
+}
+
+size_t TextureProgram::runflags(const TextureOperand& _mask, const size_t _runflags, const bool _inverse)
+{
+  TextureInstruction instruction;
+  instruction.operation = TEXTURE_RUNFLAGS;
+  instruction.output = m_runflag_count++;
+  instruction.input[0] = _mask.index;
+  instruction.runflags = _runflags;
+  instruction.inverse = _inverse;
+  m_instructions.push_back(instruction);
+
+  return instruction.output;
+}
+
+TextureOperand TextureProgram::blend(const TextureOperand& _upper, const TextureOperand& _lower, const TextureOperand& _mask)
+{
+  if(_mask.constant)
+  {
+    if((_mask.colour == 1.f).all())
+      return _upper;
+
+    if((_mask.colour == 0.f).all())
+      return _lower;
+
+    if(_upper.constant && _lower.constant)
+      return constant(_upper.colour * _mask.colour + _lower.colour * (1.f - _mask.colour));
+  }
+
+  if(_upper.constant && _lower.constant && (_upper.colour == _lower.colour).all())
+    return _upper;
+
+  TextureInstruction instruction;
+  instruction.operation = TEXTURE_BLEND;
+  instruction.input[0] = materialize(_upper);
+  instruction.input[1] = materialize(_lower);
+  instruction.input[2] = materialize(_mask);
+  instruction.output = m_register_count++;
+  m_instructions.push_back(instruction);
+
+  TextureOperand operand;
+  operand.constant = false;
+  operand.colour = Colour3f(0.f, 0.f, 0.f);
+  operand.index = instruction.output;
+  return operand;
+}
+
+size_t TextureProgram::materialize(const TextureOperand& _operand)
+{
+  if(!_operand.constant)
+    return _operand.index;
+
+  TextureInstruction instruction;
+  instruction.operation = TEXTURE_CONSTANT;
+  instruction.output = m_register_count++;
+  instruction.colour = _operand.colour;
+  m_instructions.push_back(instruction);
+
+  return instruction.output;
+}
+
+void TextureProgram::execute(
+  const size_t _size,
+  std::vector< float >& _u,
+  std::vector< float >& _v,
+  std::vector< float >& _footprint,
+  TextureSystem _texture_system,
+  TexturePerthread _thread_info,
+  std::vector< float >* _output
+  ) const
+{
+  _output->resize(3 * _size);
+
+  if(m_result.constant)
+  {
+    for(size_t channel = 0; channel < 3; ++channel)
+      std::fill(_output->begin() + channel * _size, _output->begin() + (channel + 1) * _size, m_result.colour[channel]);
+    return;
+  }
+
+  // Registers hold each channel contiguously so that the passes below vectorise
+  std::vector< float > registers(m_register_count * 3 * _size, 0.f);
+  std::vector< OpenImageIO::Runflag > runflags(m_runflag_count * _size, 0);
+  std::vector< bool > active(m_runflag_count, false);
+  std::vector< float > temp_colour;
+
+  std::fill(runflags.begin(), runflags.begin() + _size, 1);
+  active[0] = true;
+
+  for(size_t index = 0; index < m_instructions.size(); ++index)
+  {
+    const TextureInstruction& instruction = m_instructions[index];
+    float* output = &(registers[instruction.output * 3 * _size]);
+
+    switch(instruction.operation)
+    {
+      case TEXTURE_CONSTANT:
+      {
+        for(size_t channel = 0; channel < 3; ++channel)
+          std::fill(output + channel * _size, output + (channel + 1) * _size, instruction.colour[channel]);
+        break;
+      }
+
+      case TEXTURE_LOOKUP:
+      {
+        // A layer that is not visible at any point is never looked up
+        if(!active[instruction.runflags])
+          break;
+
+        temp_colour.assign(3 * _size, 0.f);
+        instruction.texture->lookup(
+          _size,
+          &(runflags[instruction.runflags * _size]),
+          _u, _v, _footprint,
+          _texture_system,
+          _thread_info,
+          &(temp_colour[0])
+          );
+
+        for(size_t point = 0; point < _size; ++point)
+        {
+          output[point] = temp_colour[3 * point + 0];
+          output[_size + point] = temp_colour[3 * point + 1];
+          output[2 * _size + point] = temp_colour[3 * point + 2];
+        }
+        break;
+      }
+
+      case TEXTURE_RUNFLAGS:
+      {
+        const OpenImageIO::Runflag* parent = &(runflags[instruction.runflags * _size]);
+        OpenImageIO::Runflag* flags = &(runflags[instruction.output * _size]);
+        const float* mask = &(registers[instruction.input[0] * 3 * _size]);
+        float target = instruction.inverse ? 1.f : 0.f;
+
+        bool any = false;
+        for(size_t point = 0; point < _size; ++point)
+        {
+          bool visible = (mask[point] != target) || (mask[_size + point] != target) || (mask[2 * _size + point] != target);
+          flags[point] = parent[point] && visible;
+          any = any || flags[point];
+        }
+
+        active[instruction.output] = any;
+        break;
+      }
+
+      case TEXTURE_BLEND:
+      {
+        const float* upper = &(registers[instruction.input[0] * 3 * _size]);
+        const float* lower = &(registers[instruction.input[1] * 3 * _size]);
+        const float* mask = &(registers[instruction.input[2] * 3 * _size]);
+
+        for(size_t point = 0; point < 3 * _size; ++point)
+          output[point] = lower[point] + (upper[point] - lower[point]) * mask[point];
+        break;
+      }
+    }
+  }
+
+  const float* result = &(registers[m_result.index * 3 * _size]);
+  std::copy(result, result + 3 * _size, _output->begin());
+}
+
+void TextureProgram::prefetch(
+  const size_t _size,
+  const float* _u,
+  const float* _v,
+  const float* _footprint,
+  TextureSystem _texture_system,
+  TexturePerthread _thread_info
+  ) const
+{
+  for(size_t index = 0; index < m_instructions.size(); ++index)
+  {
+    if(m_instructions[index].operation == TEXTURE_LOOKUP)
+      m_instructions[index].texture->prefetch(_size, _u, _v, _footprint, _texture_system, _thread_info);
+  }
+}
+
+MSC_NAMESPACE_END
@@ -13,7 +13,7 @@ void ThinLensCamera::construct()
   m_normal = (m_transform.linear().inverse().transpose() * Vector3f::UnitX()).normalized();
 }
 
-void ThinLensCamera::sample(const int _count, float* _positions, RandomGenerator* _random, RayCompressed* _ouput) const
+void ThinLensCamera::sample(const int _count, float* _positions, float* _lens, RayCompressed* _ouput) const
 {
   Vector3f nodal_point = m_translation + (m_normal * m_focal_length);
   float nodal_focal_ratio = m_focal_distance / m_focal_length;
@@ -28,7 +28,7 @@ void ThinLensCamera::sample(const int _count, float* _positions, RandomGenerator
     Vector3f film_position = m_transform * Vector3f(0.f, _positions[2 * index + 1], _positions[2 * index + 0]);
     Vector3f focal_point = film_position + (nodal_point - film_position) * nodal_focal_ratio;
 
-    Vector2f aperture_sample = rejectionSampling(_random) * (m_focal_length / m_aperture);
+    Vector2f aperture_sample = concentricSampling(_lens[2 * index + 0], _lens[2 * index + 1]) * (m_focal_length / m_aperture);
     Vector3f aperture_position = m_transform * Vector3f(0.f, aperture_sample.x(), aperture_sample.y());
 
     mapped_position = aperture_position + (m_normal * m_focal_length);
@@ -36,23 +36,29 @@ void ThinLensCamera::sample(const int _count, float* _positions, RandomGenerator
   }
 }
 
-Vector2f ThinLensCamera::rejectionSampling(RandomGenerator* _random) const
+Vector2f ThinLensCamera::concentricSampling(const float _x, const float _y) const
 {
-  float x;
-  float y;
-  Vector2f output;
+  // Maps the square onto a disk of radius one half preserving stratification
+  float x = 2.f * _x - 1.f;
+  float y = 2.f * _y - 1.f;
 
-  while(true)
-  {
-    x = _random->sample() - 0.5f;
-    y = _random->sample() - 0.5f;
-    output = Vector2f(x, y);
+  if(x == 0.f && y == 0.f)
+    return Vector2f(0.f, 0.f);
 
-    if(output.norm() < 0.5f)
-      break;
+  float radius;
+  float theta;
+  if(fabs(x) > fabs(y))
+  {
+    radius = x;
+    theta = (M_PI / 4.f) * (y / x);
+  }
+  else
+  {
+    radius = y;
+    theta = (M_PI / 2.f) - (M_PI / 4.f) * (x / y);
   }
 
-  return output;
+  return Vector2f(cos(theta), sin(theta)) * (0.5f * radius);
 }
 
 MSC_NAMESPACE_END
\ No newline at end of file
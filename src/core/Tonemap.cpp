@@ -0,0 +1,24 @@
+#include <core/Tonemap.h>
+
+MSC_NAMESPACE_BEGIN
+
+void Tonemap::operator()(const tbb::blocked_range< size_t > &r) const
+{
+  for(size_t index = r.begin(); index < r.end(); ++index)
+  {
+    const Tile& tile = m_image->tiles[m_tiles[index]];
+    size_t span = 3 * tile.width;
+
+    for(size_t index_y = tile.y; index_y < tile.y + tile.height; ++index_y)
+    {
+      size_t offset = 3 * (index_y * m_image->width + tile.x);
+      const float* input = &(m_image->pixels[0].v[0]) + offset;
+      unsigned char* output = m_output + offset;
+
+      for(size_t index_value = 0; index_value < span; ++index_value)
+        output[index_value] = static_cast< unsigned char >(fminf(1.f, fmaxf(0.f, input[index_value])) * 255.f);
+    }
+  }
+}
+
+MSC_NAMESPACE_END
@@ -87,6 +87,23 @@ void Framebuffer::image(const unsigned char* _image, const int _resolution_x, co
   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _resolution_x, _resolution_y, GL_RGB, GL_UNSIGNED_BYTE, _image);
 }
 
+void Framebuffer::image(const unsigned char* _image, const int _resolution_x, const int _resolution_y, const int _x, const int _y, const int _width, const int _height)
+{
+  glBindTexture(GL_TEXTURE_2D, m_texture);
+
+  // Rows of a region are strided by the full image width
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, _resolution_x);
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, _x);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, _y);
+
+  glTexSubImage2D(GL_TEXTURE_2D, 0, _x, _y, _width, _height, GL_RGB, GL_UNSIGNED_BYTE, _image);
+
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+}
+
 void Framebuffer::title(const std::string &_title)
 {
   glfwSetWindowTitle(m_window, _title.c_str());
@@ -11,16 +11,18 @@
 
 #include <framebuffer/Framebuffer.h>
 #include <core/Pathtracer.h>
+#include <core/SceneBundle.h>
 
 namespace program_options = boost::program_options;
 namespace filesystem = boost::filesystem;
 
-void commands(const int ac, const char *av[], filesystem::path* input, filesystem::path* output)
+void commands(const int ac, const char *av[], filesystem::path* input, filesystem::path* output, filesystem::path* bundle)
 {
   program_options::options_description visible("options");
   visible.add_options()
     ("help,h", "produce help message")
     ("output,o", program_options::value< filesystem::path >(), "output as file")
+    ("compile,c", program_options::value< filesystem::path >(), "compile scene into a bundle file and exit")
   ;
 
   program_options::options_description hidden("hidden options");
@@ -55,6 +57,9 @@ void commands(const int ac, const char *av[], filesystem::path* input, filesyste
 
     if(vm.count("input"))
       *input = vm["input"].as< filesystem::path >();
+
+    if(vm.count("compile"))
+      *bundle = vm["compile"].as< filesystem::path >();
   }
   catch(program_options::required_option& error)
   {
@@ -116,6 +121,12 @@ void compute(msc::Pathtracer* pathtracer, size_t* iteration)
 
     std::cout << "\033[1;31mIteration " << *iteration << " is complete.\033[0m" << std::endl;
 
+    if(pathtracer->converged())
+    {
+      std::cout << "\033[1;31mImage has converged after " << *iteration << " iterations.\033[0m" << std::endl;
+      break;
+    }
+
     boost::chrono::high_resolution_clock::time_point timer_end = boost::chrono::high_resolution_clock::now();
     boost::chrono::milliseconds iteration_time(boost::chrono::duration_cast<boost::chrono::milliseconds>
       (timer_end - timer_start).count());
@@ -128,13 +139,40 @@ int main(int argc, const char *argv[])
 {
   filesystem::path input_file;
   filesystem::path output_file;
+  filesystem::path bundle_file;
+
+  commands(argc, argv, &input_file, &output_file, &bundle_file);
 
-  commands(argc, argv, &input_file, &output_file);
+  if(!bundle_file.empty())
+  {
+    try
+    {
+      msc::SceneBundle::compile(input_file.string(), bundle_file.string());
+    }
+    catch(std::exception& error)
+    {
+      std::cerr << "error: " << error.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "\033[1;31mScene bundle named " << bundle_file << " written to working directory.\033[0m" << std::endl;
+    return EXIT_SUCCESS;
+  }
 
   float* image_pointer;
   int width, height;
 
-  msc::Pathtracer* pathtracer = new msc::Pathtracer(input_file.string());
+  msc::Pathtracer* pathtracer = NULL;
+  try
+  {
+    pathtracer = new msc::Pathtracer(input_file.string());
+  }
+  catch(std::exception& error)
+  {
+    std::cerr << "error: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
   pathtracer->image(&image_pointer, &width, &height);
 
   size_t pixel_count = width * height;
@@ -166,17 +204,15 @@ int main(int argc, const char *argv[])
       if(check_it != iteration)
       {
         check_it = iteration;
-        for(size_t i = 0; i < pixel_count; ++i)
-        {
-          image[3 * i + 0] = static_cast<unsigned char>(std::min(1.f, image_pointer[3 * i + 0] / iteration) * 255.f);
-          image[3 * i + 1] = static_cast<unsigned char>(std::min(1.f, image_pointer[3 * i + 1] / iteration) * 255.f);
-          image[3 * i + 2] = static_cast<unsigned char>(std::min(1.f, image_pointer[3 * i + 2] / iteration) * 255.f);
-        }
+
+        std::vector< msc::Tile > tiles;
+        pathtracer->preview(image, &tiles);
 
         std::string title = "Pathtracer Iteration: " + boost::lexical_cast<std::string>(iteration);
 
         framebuffer->title(title);
-        framebuffer->image(image, width, height);
+        for(size_t i = 0; i < tiles.size(); ++i)
+          framebuffer->image(image, width, height, tiles[i].x, tiles[i].y, tiles[i].width, tiles[i].height);
       }
 
       framebuffer->draw();
@@ -198,6 +234,10 @@ int main(int argc, const char *argv[])
   {
     size_t iteration = pathtracer->process();
 
+    // Keep refining until converged when a stopping criterion is set
+    while(iteration != 0 && pathtracer->adaptive() && !pathtracer->converged())
+      iteration = pathtracer->process();
+
     Imf::Rgba* image = new Imf::Rgba[pixel_count];
 
     for(size_t i = 0; i < pixel_count; ++i)